@@ -17,9 +17,27 @@
 const IOport CGA::index_port(0x3d4);
 const IOport CGA::data_port(0x3d5);
 
-const bse::span<CGA::cga_char_t, CGA::ROWS * CGA::COLUMNS> CGA::SCREEN{reinterpret_cast<CGA::cga_char_t*>(0xb8000U)};
-const bse::span<CGA::cga_line_t, CGA::ROWS> CGA::SCREEN_ROWS{reinterpret_cast<CGA::cga_line_t*>(0xb8000U)};
-CGA::cga_page_t* const CGA::SCREEN_PAGE {reinterpret_cast<CGA::cga_page_t*>(0xb8000U)};
+const bse::span<CGA::cga_char_t, CGA::VRAM_ROWS * CGA::COLUMNS> CGA::VRAM{reinterpret_cast<CGA::cga_char_t*>(0xb8000U)};
+const bse::span<CGA::cga_line_t, CGA::VRAM_ROWS> CGA::VRAM_LINES{reinterpret_cast<CGA::cga_line_t*>(0xb8000U)};
+
+unsigned int CGA::top = 0;
+unsigned int CGA::view = 0;
+
+/*****************************************************************************
+ * Methode:         CGA::set_start                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Setzt die erste angezeigte Zeile des Bildschirmspeichers.*
+ *****************************************************************************/
+void CGA::set_start(unsigned int line) {
+    // Like the cursor the start address counts characters, not bytes
+    unsigned short start = line * COLUMNS;
+
+    index_port.outb(0xC);  // Start address(high)
+    data_port.outb((start >> 8) & 0xFF);
+
+    index_port.outb(0xD);  // Start address(low)
+    data_port.outb(start & 0xFF);
+}
 
 /*****************************************************************************
  * Methode:         CGA::setpos                                              *
@@ -30,8 +48,8 @@ void CGA::setpos(unsigned int x, unsigned int y) {
 
     /* Hier muess Code eingefuegt werden */
 
-    // NOTE: The cursor addresses positions on screen, not bytes
-    unsigned short pos = x + y * COLUMNS;
+    // NOTE: The cursor addresses positions in video memory, not bytes
+    unsigned short pos = x + (top + y) * COLUMNS;
     unsigned char cursor_low = pos & 0xFF;
     unsigned char cursor_high = (pos >> 8) & 0xFF;
 
@@ -63,7 +81,7 @@ void CGA::getpos(unsigned int& x, unsigned int& y) {
       (cursor_low & 0xFF) | ((cursor_high << 8) & 0xFF00);
 
     x = cursor % COLUMNS;
-    y = (cursor / COLUMNS);
+    y = (cursor / COLUMNS) - top;
 }
 
 /*****************************************************************************
@@ -86,7 +104,7 @@ void CGA::show(unsigned int x, unsigned int y, char character, unsigned char att
         return;
     }
 
-    cga_char_t* pos = SCREEN[x + y * COLUMNS];
+    cga_char_t* pos = VRAM[x + (top + y) * COLUMNS];
     pos->cga_char = character;
     pos->cga_attribute = attrib;
 }
@@ -110,6 +128,12 @@ void CGA::print(const bse::string_view string, unsigned char attrib) const {
     unsigned int cursor_y = 0;  // Don't poll registers every stroke
     getpos(cursor_x, cursor_y);
 
+    if (view != 0) {
+        // Show the new output
+        view = 0;
+        set_start(top);
+    }
+
     for (char current : string) {
         if (current == '\n') {
             cursor_x = 0;
@@ -159,11 +183,25 @@ void CGA::scrollup() const {
 
     /* Hier muss Code eingefuegt werden */
 
-    // Move up
-    bse::memcpy<cga_line_t>(SCREEN_ROWS[0], SCREEN_ROWS[1], ROWS - 1);
+    if (top + ROWS >= VRAM_ROWS) {
+        // End of video memory: Move the screen (without the line that scrolls out) and the newest
+        // history lines back to the start
+        unsigned int history = top + 1 < SCROLLBACK_KEEP ? top + 1 : SCROLLBACK_KEEP;
+        unsigned int first = top + 1 - history;
+        bse::memmove(VRAM_LINES[0], VRAM_LINES[first], (history + ROWS - 1) * sizeof(cga_line_t));
+        top = history;
+    } else {
+        top = top + 1;
+    }
 
-    // Clear last line
-    bse::zero<cga_line_t>(SCREEN_ROWS[ROWS - 1]);
+    // Clear last line, the only one in video memory that has to be touched
+    bse::zero<cga_line_t>(VRAM_LINES[top + ROWS - 1]);
+
+    // The history view stays on the same lines while they exist
+    if (view != 0) {
+        view = view + 1 <= top ? view + 1 : top;
+    }
+    set_start(top - view);
 }
 
 /*****************************************************************************
@@ -175,10 +213,44 @@ void CGA::clear() {
 
     /* Hier muess Code eingefuegt werden */
 
-    bse::zero<cga_page_t>(SCREEN_PAGE);
+    // Drops the history
+    top = 0;
+    view = 0;
+    set_start(0);
+
+    bse::memset(VRAM_LINES[0], '\0', ROWS * sizeof(cga_line_t));
     setpos(0, 0);
 }
 
+/*****************************************************************************
+ * Methode:         CGA::scrollback                                          *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Blaettert in den bereits herausgescrollten Zeilen.       *
+ *                                                                           *
+ * Parameter:                                                                *
+ *      lines       Zeilen zurueck (positiv) oder vor (negativ)              *
+ *****************************************************************************/
+void CGA::scrollback(int lines) {
+    int wanted = static_cast<int>(view) + lines;
+    if (wanted < 0) {
+        wanted = 0;
+    }
+
+    view = static_cast<unsigned int>(wanted) < top ? wanted : top;
+    set_start(top - view);
+}
+
+/*****************************************************************************
+ * Methode:         CGA::reset_scroll                                        *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Zeigt wieder den Anfang des Bildschirmspeichers an.      *
+ *****************************************************************************/
+void CGA::reset_scroll() {
+    top = 0;
+    view = 0;
+    set_start(0);
+}
+
 /*****************************************************************************
  * Methode:         CGA::attribute                                           *
  *---------------------------------------------------------------------------*
@@ -31,6 +31,7 @@ public:
 
     // Konstruktur mit Initialisierung der Ports
     CGA() {
+        CGA::set_start(0);
         CGA::setpos(0, 0);
     }
 
@@ -74,13 +75,26 @@ public:
         bse::array<cga_char_t, COLUMNS> cga_line;
     };
 
-    struct cga_page_t {
-        bse::array<cga_line_t, ROWS> cga_page;
-    };
+    // NOTE: The text mode video memory has room for many more lines than the 25 visible ones.
+    //       The visible window starts at line 'top' and is moved with the CRTC start address
+    //       registers, so scrolling only has to clear the newly exposed line instead of copying
+    //       the whole screen. The lines above 'top' are the scrollback history.
+    //       When the window reaches the end of the video memory the screen and the most recent
+    //       SCROLLBACK_KEEP lines are copied back to the start, once every ~130 lines.
+    static constexpr const unsigned int VRAM_ROWS = 0x8000 / (COLUMNS * sizeof(cga_char_t));  // 32 KiB text memory
+    static constexpr const unsigned int SCROLLBACK_KEEP = 2 * ROWS;
+
+    static const bse::span<cga_char_t, VRAM_ROWS * COLUMNS> VRAM;
+    static const bse::span<cga_line_t, VRAM_ROWS> VRAM_LINES;
+
+private:
+    static unsigned int top;   // First visible line in video memory
+    static unsigned int view;  // Lines scrolled back into the history, 0 shows the newest output
 
-    static const bse::span<cga_char_t, ROWS * COLUMNS> SCREEN;
-    static const bse::span<cga_line_t, ROWS> SCREEN_ROWS;
-    static cga_page_t* const SCREEN_PAGE;  // No span because can't address anything in [0, 1]
+    // Sets the first line the graphics card displays
+    static void set_start(unsigned int line);
+
+public:
 
     // Setzen des Cursors in Spalte x und Zeile y.
     static void setpos(unsigned int x, unsigned int y);
@@ -101,6 +115,13 @@ public:
     // Lösche den Textbildschirm
     virtual void clear();
 
+    // Scrolls the view lines back into the history (negative: towards the newest output),
+    // new output always jumps back to the newest lines
+    static void scrollback(int lines);
+
+    // Displays video memory from the start again, for the bluescreen that writes there directly
+    static void reset_scroll();
+
     // Hilfsfunktion zur Erzeugung eines Attribut-Bytes
     static unsigned char attribute(CGA::color bg, CGA::color fg, bool blink);
 };
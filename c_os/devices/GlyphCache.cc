@@ -0,0 +1,76 @@
+/*****************************************************************************
+ *                                                                           *
+ *                           G L Y P H C A C H E                             *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Zwischenspeicher fuer Zeichen einer Schrift, die bereits *
+ *                  in das Pixelformat des Framebuffers umgewandelt wurden.  *
+ *****************************************************************************/
+
+#include "devices/GlyphCache.h"
+
+GlyphCache::Face& GlyphCache::face(const Font& font, const PixelOps& ops, unsigned int fg, unsigned int bg) {
+    for (Face& face : faces) {
+        if (face.font == &font && face.ops == &ops && face.fg == fg && face.bg == bg) {
+            return face;
+        }
+    }
+
+    Face& victim = faces[next_victim];
+    next_victim = (next_victim + 1) % FACES;
+
+    drop(victim);
+    victim.font = &font;
+    victim.ops = &ops;
+    victim.fg = fg;
+    victim.bg = bg;
+    return victim;
+}
+
+void GlyphCache::drop(Face& face) {
+    if (face.font == nullptr) {
+        return;
+    }
+
+    for (unsigned char*& glyph : face.glyphs) {
+        delete[] glyph;
+        glyph = nullptr;
+    }
+    face.font = nullptr;
+}
+
+const unsigned char* GlyphCache::get(const Font& font, const PixelOps& ops, unsigned int fg, unsigned int bg, unsigned char c) {
+    Face& cached = face(font, ops, fg, bg);
+    if (cached.glyphs[c] != nullptr) {
+        return cached.glyphs[c];
+    }
+
+    const unsigned int width = font.get_char_width();
+    const unsigned int height = font.get_char_height();
+    const unsigned int row_bytes = width * ops.bytes;
+    const unsigned int width_byte = width / 8 + ((width % 8 != 0) ? 1 : 0);
+
+    unsigned char* glyph = new unsigned char[row_bytes * height];
+    if (glyph == nullptr) {
+        return nullptr;
+    }
+
+    // Background first, then the set bits on top
+    const unsigned char* bitmap = font.getChar(c);
+    unsigned char* row = glyph;
+    for (unsigned int y = 0; y < height; ++y) {
+        ops.span(row, width, bg);
+        ops.mono_row(row, bitmap, 0, width, fg);
+        bitmap += width_byte;
+        row += row_bytes;
+    }
+
+    cached.glyphs[c] = glyph;
+    return glyph;
+}
+
+void GlyphCache::flush() {
+    for (Face& face : faces) {
+        drop(face);
+    }
+}
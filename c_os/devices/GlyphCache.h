@@ -0,0 +1,57 @@
+/*****************************************************************************
+ *                                                                           *
+ *                           G L Y P H C A C H E                             *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Zwischenspeicher fuer Zeichen einer Schrift, die bereits *
+ *                  in das Pixelformat des Framebuffers umgewandelt wurden.  *
+ *****************************************************************************/
+
+#ifndef GlyphCache_include__
+#define GlyphCache_include__
+
+#include "devices/PixelFormat.h"
+#include "devices/fonts/Fonts.h"
+#include "user/lib/Array.h"
+
+// NOTE: The fonts are stored with 1 bit per pixel, so every drawn character had to be decoded bit by bit.
+//       A glyph is expanded once per font/color combination (a "face") into a block of ready to copy
+//       pixels, text is then drawn by copying whole glyph rows into the framebuffer.
+//       Glyphs are expanded lazily on first use, as a 12x22 font at 32 bpp already takes 1 KiB per glyph.
+//       If all faces are in use the oldest one is thrown away.
+class GlyphCache {
+public:
+    static constexpr const unsigned int FACES = 4;
+    static constexpr const unsigned int GLYPHS = 256;
+
+private:
+    struct Face {
+        const Font* font = nullptr;
+        const PixelOps* ops = nullptr;
+        unsigned int fg = 0;
+        unsigned int bg = 0;
+        bse::array<unsigned char*, GLYPHS> glyphs {};
+    };
+
+    bse::array<Face, FACES> faces;
+    unsigned int next_victim = 0;  // Faces are replaced round robin
+
+    Face& face(const Font& font, const PixelOps& ops, unsigned int fg, unsigned int bg);
+    static void drop(Face& face);
+
+public:
+    GlyphCache(const GlyphCache& copy) = delete;
+
+    GlyphCache() = default;
+
+    // No destructor, the global graphics object would need atexit. Call flush() instead.
+
+    // Expands a glyph to font width * font height pixels in the format of ops with fg and bg already
+    // encoded. Returns nullptr if no memory is left.
+    const unsigned char* get(const Font& font, const PixelOps& ops, unsigned int fg, unsigned int bg, unsigned char c);
+
+    // Frees all glyphs, has to be called when the pixel format changes
+    void flush();
+};
+
+#endif
@@ -13,6 +13,8 @@
  *****************************************************************************/
 
 #include "devices/LFBgraphics.h"
+#include "devices/PixelFormat.h"
+#include "user/lib/mem/Memory.h"
 
 /* Hilfsfunktionen */
 void swap(unsigned int* a, unsigned int* b);
@@ -38,21 +40,24 @@ int abs(int a);
 inline void LFBgraphics::drawMonoBitmap(unsigned int x, unsigned int y,
                                         unsigned int width, unsigned int height,
                                         const unsigned char* bitmap, unsigned int color) const {
+    if (!drawable() || x >= xres || y >= yres) {
+        return;
+    }
+
     // Breite in Bytes
     unsigned short width_byte = width / 8 + ((width % 8 != 0) ? 1 : 0);
 
-    for (unsigned int yoff = 0; yoff < height; ++yoff) {
-        unsigned int xpos = x;
-        unsigned int ypos = y + yoff;
-        for (unsigned int xb = 0; xb < width_byte; ++xb) {
-            for (int src = 7; src >= 0; --src) {
-                if ((1 << src) & *bitmap) {
-                    drawPixel(xpos, ypos, color);
-                }
-                xpos++;
-            }
-            bitmap++;
-        }
+    // Clip once for the whole bitmap
+    unsigned int visible_width = width < xres - x ? width : xres - x;
+    unsigned int visible_height = height < yres - y ? height : yres - y;
+    unsigned int px = ops->encode(color);
+    unsigned char* dst = pixelAddress(x, y);
+
+    markDirty(x, y, x + visible_width, y + visible_height);
+    for (unsigned int yoff = 0; yoff < visible_height; ++yoff) {
+        ops->mono_row(dst, bitmap, 0, visible_width, px);
+        bitmap += width_byte;
+        dst += pitch();
     }
 }
 
@@ -76,6 +81,57 @@ void LFBgraphics::drawString(const Font& fnt, unsigned int x, unsigned int y,
     }
 }
 
+/*****************************************************************************
+ * Methode:         LFBgraphics::drawText                                    *
+ *---------------------------------------------------------------------------*
+ * Parameter:       fnt     Schrift                                          *
+ *                  x,y     Startpunkt ab dem Text ausgegeben wird.          *
+ *                  fg      Farbe des Textes                                 *
+ *                  bg      Hintergrundfarbe                                 *
+ *                  str     Zeiger auf Zeichenkette                          *
+ *                  len     Laenge der Zeichenkette                          *
+ *                                                                           *
+ * Beschreibung:    Gibt eine Zeichenkette mit Hintergrund aus. Die Zeichen  *
+ *                  kommen aus dem Glyph-Cache und werden zeilenweise        *
+ *                  kopiert.                                                 *
+ *****************************************************************************/
+void LFBgraphics::drawText(const Font& fnt, unsigned int x, unsigned int y,
+                           unsigned int fg, unsigned int bg, const char* str, unsigned int len) const {
+    if (!drawable() || x >= xres || y >= yres || len == 0) {
+        return;
+    }
+
+    const unsigned int char_width = fnt.get_char_width();
+    const unsigned int glyph_row = char_width * ops->bytes;
+    const unsigned int fg_px = ops->encode(fg);
+    const unsigned int bg_px = ops->encode(bg);
+
+    // Clip the whole run once, only the last visible character can be cut off
+    unsigned int visible_width = len * char_width < xres - x ? len * char_width : xres - x;
+    unsigned int visible_height = fnt.get_char_height() < yres - y ? fnt.get_char_height() : yres - y;
+
+    markDirty(x, y, x + visible_width, y + visible_height);
+
+    unsigned char* dst = pixelAddress(x, y);
+    for (unsigned int i = 0; i < len && visible_width > 0; ++i) {
+        unsigned int width = char_width < visible_width ? char_width : visible_width;
+        const unsigned char* glyph = glyphs.get(fnt, *ops, fg_px, bg_px, static_cast<unsigned char>(str[i]));
+        if (glyph == nullptr) {
+            return;
+        }
+
+        unsigned char* row = dst;
+        for (unsigned int yoff = 0; yoff < visible_height; ++yoff) {
+            bse::memcpy_bytes(row, glyph, width * ops->bytes);
+            glyph += glyph_row;
+            row += pitch();
+        }
+
+        dst += glyph_row;
+        visible_width -= width;
+    }
+}
+
 /*****************************************************************************
  * Methode:         LFBgraphics::drawPixel                                   *
  *---------------------------------------------------------------------------*
@@ -85,51 +141,36 @@ void LFBgraphics::drawString(const Font& fnt, unsigned int x, unsigned int y,
  * Beschreibung:    Zeichnen eines Pixels.                                   *
  *****************************************************************************/
 void LFBgraphics::drawPixel(unsigned int x, unsigned int y, unsigned int col) const {
-    unsigned char* ptr = reinterpret_cast<unsigned char*>(lfb);
-
-    if (hfb == 0 || lfb == 0) {
+    // Pixel ausserhalb des sichtbaren Bereichs?
+    if (!drawable() || x >= xres || y >= yres) {
         return;
     }
 
-    if (mode == BUFFER_INVISIBLE) {
-        ptr = reinterpret_cast<unsigned char*>(hfb);
-    }
+    markDirty(x, y, x + 1, y + 1);
+    ops->pixel(pixelAddress(x, y), ops->encode(col));
+}
 
-    // Pixel ausserhalb des sichtbaren Bereichs?
-    if (x < 0 || x >= xres || y < 0 || y > yres) {
+/*****************************************************************************
+ * Methode:         LFBgraphics::drawSpan                                    *
+ *---------------------------------------------------------------------------*
+ * Parameter:       x, y    Startpunkt                                       *
+ *                  len     Laenge in Pixeln                                 *
+ *                  col     Farbe                                            *
+ *                                                                           *
+ * Beschreibung:    Zeichnet eine horizontale Linie, wird einmal am Rand     *
+ *                  abgeschnitten statt fuer jeden Pixel.                    *
+ *****************************************************************************/
+void LFBgraphics::drawSpan(unsigned int x, unsigned int y, unsigned int len, unsigned int col) const {
+    if (!drawable() || x >= xres || y >= yres) {
         return;
     }
 
-    // Adresse des Pixels berechnen und Inhalt schreiben
-    switch (bpp) {
-    case 8:
-        ptr += (x + y * xres);
-        *ptr = col;
-        return;
-    case 15:
-    case 16:
-        ptr += (2 * x + 2 * y * xres);
-        *ptr = col;
-        return;
-    case 24:
-        ptr += (3 * x + 3 * y * xres);
-        *ptr = (col & 0xFF);
-        ptr++;
-        *ptr = ((col >> 8) & 0xFF);
-        ptr++;
-        *ptr = ((col >> 16) & 0xFF);
-        ptr;
-        return;
-    case 32:
-        ptr += (4 * x + 4 * y * xres);
-        *ptr = (col & 0xFF);
-        ptr++;
-        *ptr = ((col >> 8) & 0xFF);
-        ptr++;
-        *ptr = ((col >> 16) & 0xFF);
-        ptr;
-        return;
+    if (len > xres - x) {
+        len = xres - x;
     }
+
+    markDirty(x, y, x + len, y + 1);
+    ops->span(pixelAddress(x, y), len, ops->encode(col));
 }
 
 void LFBgraphics::drawStraightLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, unsigned int col) const {
@@ -137,14 +178,15 @@ void LFBgraphics::drawStraightLine(unsigned int x1, unsigned int y1, unsigned in
 
     if (x1 == x2 && y2 > y1) {
         // Vertical line
-        for (unsigned int i = y1; i <= y2; ++i) {
-            drawPixel(x1, i, col);
+        if (!drawable() || x1 >= xres || y1 >= yres) {
+            return;
         }
+        unsigned int len = y2 - y1 + 1 < yres - y1 ? y2 - y1 + 1 : yres - y1;
+        markDirty(x1, y1, x1 + 1, y1 + len);
+        ops->column(pixelAddress(x1, y1), len, pitch(), ops->encode(col));
     } else if (y1 == y2 && x2 > x1) {
         // Horizontal line
-        for (unsigned int i = x1; i <= x2; ++i) {
-            drawPixel(i, y1, col);
-        }
+        drawSpan(x1, y1, x2 - x1 + 1, col);
     } else {
         // Not straight
     }
@@ -160,32 +202,82 @@ void LFBgraphics::drawRectangle(unsigned int x1, unsigned int y1, unsigned int x
     drawStraightLine(x1, y1, x1, y2, col);
 }
 
+// Like drawRectangle, but filled row by row
+void LFBgraphics::fillRectangle(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, unsigned int col) const {
+    if (!drawable() || x2 < x1 || y2 < y1 || x1 >= xres || y1 >= yres) {
+        return;
+    }
+
+    // Clip and convert the color once, then fill row by row
+    unsigned int width = x2 - x1 + 1 < xres - x1 ? x2 - x1 + 1 : xres - x1;
+    unsigned int height = y2 - y1 + 1 < yres - y1 ? y2 - y1 + 1 : yres - y1;
+    unsigned int px = ops->encode(col);
+    unsigned char* dst = pixelAddress(x1, y1);
+
+    markDirty(x1, y1, x1 + width, y1 + height);
+    for (unsigned int y = 0; y < height; ++y) {
+        ops->span(dst, width, px);
+        dst += pitch();
+    }
+}
+
 void LFBgraphics::drawCircle(unsigned int x, unsigned int y, unsigned int rad, unsigned int col) const {
     // TODO
 }
 
 void LFBgraphics::drawSprite(unsigned int width, unsigned int height, unsigned int bytes_pp, const unsigned char* pixel_data) const {
-    const unsigned char* ptr;
-    for (unsigned int x = 0; x < width; ++x) {
-        for (unsigned int y = 0; y < height; ++y) {
-            ptr = pixel_data + (x + y * width) * bytes_pp;
-
-            switch (bytes_pp) {
-            case 2:
-                // TODO: Never tested, probably doesn't work
-                drawPixel(x, y, RGB_24(*ptr & 0b11111000, ((*ptr & 0b111) << 3) | (*(ptr + 1) >> 5),
-                                             *(ptr + 1) & 0b11111));  // RGB 565
-                break;
-            case 3:
-            case 4:
-                // Alpha gets ignored anyway
-                drawPixel(x, y, RGB_24(*ptr, *(ptr + 1), *(ptr + 2)));
-                break;
-            }
-        }
+    if (!drawable() || (bytes_pp < 2 || bytes_pp > 4)) {
+        return;
+    }
+
+    unsigned int visible_width = width < xres ? width : xres;
+    unsigned int visible_height = height < yres ? height : yres;
+    unsigned char* dst = pixelAddress(0, 0);
+
+    markDirty(0, 0, visible_width, visible_height);
+    for (unsigned int y = 0; y < visible_height; ++y) {
+        ops->sprite_row(dst, pixel_data, visible_width, bytes_pp);
+        pixel_data += width * bytes_pp;
+        dst += pitch();
     }
 }
 
+/*****************************************************************************
+ * Methode:         LFBgraphics::selectPixelFormat                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Waehlt die Zeichenroutinen passend zur Farbtiefe aus,    *
+ *                  muss nach jedem Moduswechsel aufgerufen werden.          *
+ *****************************************************************************/
+void LFBgraphics::selectPixelFormat() {
+    switch (bpp) {
+    case 8: ops = &PixelPipeline<PixelFormat8>::ops; break;
+    case 15: ops = &PixelPipeline<PixelFormat15>::ops; break;
+    case 16: ops = &PixelPipeline<PixelFormat16>::ops; break;
+    case 24: ops = &PixelPipeline<PixelFormat24>::ops; break;
+    case 32: ops = &PixelPipeline<PixelFormat32>::ops; break;
+    default: ops = nullptr;
+    }
+
+    // The glyphs were expanded for the old format
+    glyphs.flush();
+}
+
+/*****************************************************************************
+ * Methode:         LFBgraphics::words                                       *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Groesse eines Puffers in 32 Bit Worten.                  *
+ *****************************************************************************/
+unsigned int LFBgraphics::words() const {
+    switch (bpp) {
+    case 8: return (xres / 4) * yres;
+    case 15:
+    case 16: return 2 * (xres / 4) * yres;
+    case 24: return 3 * (xres / 4) * yres;
+    case 32: return 4 * (xres / 4) * yres;
+    }
+    return 0;
+}
+
 /*****************************************************************************
  * Methode:         LFBgraphics::clear                                       *
  *---------------------------------------------------------------------------*
@@ -193,7 +285,6 @@ void LFBgraphics::drawSprite(unsigned int width, unsigned int height, unsigned i
  *****************************************************************************/
 void LFBgraphics::clear() const {
     unsigned int* ptr = reinterpret_cast<unsigned int*>(lfb);
-    unsigned int i;
 
     if (hfb == 0 || lfb == 0) {
         return;
@@ -203,29 +294,8 @@ void LFBgraphics::clear() const {
         ptr = reinterpret_cast<unsigned int*>(hfb);
     }
 
-    switch (bpp) {
-    case 8:
-        for (i = 0; i < ((xres / 4) * yres); i++) {
-            *(ptr++) = 0;
-        }
-        return;
-    case 15:
-    case 16:
-        for (i = 0; i < (2 * (xres / 4) * yres); i++) {
-            *(ptr++) = 0;
-        }
-        return;
-    case 24:
-        for (i = 0; i < (3 * (xres / 4) * yres); i++) {
-            *(ptr++) = 0;
-        }
-        return;
-    case 32:
-        for (i = 0; i < (4 * (xres / 4) * yres); i++) {
-            *(ptr++) = 0;
-        }
-        return;
-    }
+    markDirty(0, 0, xres, yres);
+    bse::memset32(ptr, 0, words());
 }
 
 /*****************************************************************************
@@ -243,37 +313,92 @@ void LFBgraphics::setDrawingBuff(int v) {
  * Beschreibung:    Kopiert den versteckten Puffer in den sichtbaren LFB.    *
  *****************************************************************************/
 void LFBgraphics::copyHiddenToVisible() const {
-    unsigned int* sptr = reinterpret_cast<unsigned int*>(hfb);
-    unsigned int* dptr = reinterpret_cast<unsigned int*>(lfb);
-    unsigned int i;
-
     if (hfb == 0 || lfb == 0) {
         return;
     }
 
-    switch (bpp) {
-    case 8:
-        for (i = 0; i < ((xres / 4) * yres); i++) {
-            *(dptr++) = *(sptr++);
-        }
+    bse::memcpy_bytes(reinterpret_cast<void*>(lfb), reinterpret_cast<void*>(hfb), words() * 4);
+    dirty_count = 0;
+}
+
+/*****************************************************************************
+ * Methode:         LFBgraphics::markDirty                                   *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Merkt sich einen veraenderten Bereich des versteckten    *
+ *                  Puffers fuer present().                                  *
+ *****************************************************************************/
+void LFBgraphics::markDirty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const {
+    if (mode != BUFFER_INVISIBLE) {
         return;
-    case 15:
-    case 16:
-        for (i = 0; i < (2 * (xres / 4) * yres); i++) {
-            *(dptr++) = *(sptr++);
+    }
+
+    // Touching rectangles are merged, consecutive pixels/spans mostly hit the first check
+    for (unsigned int i = dirty_count; i > 0; --i) {
+        LFBrect& rect = dirty[i - 1];
+        if (x1 <= rect.x2 && x2 >= rect.x1 && y1 <= rect.y2 && y2 >= rect.y1) {
+            rect.x1 = x1 < rect.x1 ? x1 : rect.x1;
+            rect.y1 = y1 < rect.y1 ? y1 : rect.y1;
+            rect.x2 = x2 > rect.x2 ? x2 : rect.x2;
+            rect.y2 = y2 > rect.y2 ? y2 : rect.y2;
+            return;
         }
+    }
+
+    if (dirty_count < MAX_DIRTY) {
+        dirty[dirty_count++] = {x1, y1, x2, y2};
         return;
-    case 24:
-        for (i = 0; i < (3 * (xres / 4) * yres); i++) {
-            *(dptr++) = *(sptr++);
+    }
+
+    // All slots used, grow the rectangle that gets the least bigger
+    unsigned int best = 0;
+    unsigned int best_growth = ~0U;
+    for (unsigned int i = 0; i < dirty_count; ++i) {
+        const LFBrect& rect = dirty[i];
+        unsigned int ux1 = x1 < rect.x1 ? x1 : rect.x1;
+        unsigned int uy1 = y1 < rect.y1 ? y1 : rect.y1;
+        unsigned int ux2 = x2 > rect.x2 ? x2 : rect.x2;
+        unsigned int uy2 = y2 > rect.y2 ? y2 : rect.y2;
+        unsigned int growth = (ux2 - ux1) * (uy2 - uy1) - (rect.x2 - rect.x1) * (rect.y2 - rect.y1);
+        if (growth < best_growth) {
+            best = i;
+            best_growth = growth;
         }
+    }
+
+    LFBrect& rect = dirty[best];
+    rect.x1 = x1 < rect.x1 ? x1 : rect.x1;
+    rect.y1 = y1 < rect.y1 ? y1 : rect.y1;
+    rect.x2 = x2 > rect.x2 ? x2 : rect.x2;
+    rect.y2 = y2 > rect.y2 ? y2 : rect.y2;
+}
+
+/*****************************************************************************
+ * Methode:         LFBgraphics::present                                     *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Kopiert die veraenderten Bereiche des versteckten        *
+ *                  Puffers zeilenweise in den sichtbaren LFB.               *
+ *****************************************************************************/
+void LFBgraphics::present() const {
+    if (hfb == 0 || lfb == 0) {
         return;
-    case 32:
-        for (i = 0; i < (4 * (xres / 4) * yres); i++) {
-            *(dptr++) = *(sptr++);
+    }
+
+    const unsigned int bytes_pp = bytesPerPixel();
+    const unsigned int line = xres * bytes_pp;
+
+    for (unsigned int i = 0; i < dirty_count; ++i) {
+        const LFBrect& rect = dirty[i];
+        unsigned int offset = rect.y1 * line + rect.x1 * bytes_pp;
+        unsigned int bytes = (rect.x2 - rect.x1) * bytes_pp;
+
+        for (unsigned int y = rect.y1; y < rect.y2; ++y) {
+            bse::memcpy_bytes(reinterpret_cast<unsigned char*>(lfb) + offset,
+                              reinterpret_cast<unsigned char*>(hfb) + offset, bytes);
+            offset += line;
         }
-        return;
     }
+
+    dirty_count = 0;
 }
 
 void swap(unsigned int* a, unsigned int* b) {
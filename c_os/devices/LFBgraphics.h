@@ -15,7 +15,9 @@
 #ifndef LFBgraphics_include__
 #define LFBgraphics_include__
 
+#include "devices/GlyphCache.h"
 #include "devices/fonts/Fonts.h"
+#include "user/lib/Array.h"
 
 // Hilfsfunktionen um Farbwerte fuer einen Pixel zu erzeugen
 constexpr unsigned int RGB_24(unsigned int r, unsigned int g, unsigned int b) {
@@ -25,6 +27,11 @@ constexpr unsigned int RGB_24(unsigned int r, unsigned int g, unsigned int b) {
 constexpr const bool BUFFER_INVISIBLE = false;
 constexpr const bool BUFFER_VISIBLE  = true;
 
+// Rechteck in Pixeln, x2 und y2 gehoeren nicht mehr dazu
+struct LFBrect {
+    unsigned int x1, y1, x2, y2;
+};
+
 class LFBgraphics {
 private:
     // Hilfsfunktion fuer drawString
@@ -32,6 +39,44 @@ private:
                         unsigned int width, unsigned int height,
                         const unsigned char* bitmap, unsigned int col) const;
 
+    // Groesse eines Puffers in 32 Bit Worten (0 bei unbekannter Farbtiefe)
+    unsigned int words() const;
+
+    // Zeichenroutinen der aktuellen Farbtiefe (see PixelFormat.h), nullptr bei unbekannter Farbtiefe
+    const PixelOps* ops = nullptr;
+
+    bool drawable() const { return ops != nullptr && hfb != 0 && lfb != 0; }
+
+    // Puffer in den gerade gezeichnet wird
+    unsigned char* drawingBuff() const { return reinterpret_cast<unsigned char*>(mode == BUFFER_INVISIBLE ? hfb : lfb); }
+
+    unsigned int pitch() const { return xres * bytesPerPixel(); }
+    unsigned char* pixelAddress(unsigned int x, unsigned int y) const { return drawingBuff() + y * pitch() + x * bytesPerPixel(); }
+
+    // NOTE: Everything drawn to the hidden buffer is recorded here, so present() only has to copy
+    //       the changed parts to the framebuffer instead of the whole screen.
+    //       Rectangles that touch are merged, if all slots are used the new rectangle is merged
+    //       with the one that grows the least. This only records damage, so the drawing
+    //       functions stay const.
+    static constexpr const unsigned int MAX_DIRTY = 16;
+    mutable bse::array<LFBrect, MAX_DIRTY> dirty;
+    mutable unsigned int dirty_count = 0;
+
+    // Already clipped to the screen
+    void markDirty(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const;
+
+    // Expanded glyphs for drawText, like the dirty rectangles this is only a cache
+    mutable GlyphCache glyphs;
+
+protected:
+    unsigned int bytesPerPixel() const { return (bpp + 7) / 8; }
+
+    // Nach einem Moduswechsel passen die Bereiche nicht mehr zum Puffer
+    void discardDirty() const { dirty_count = 0; }
+
+    // Nach einem Moduswechsel aufrufen
+    void selectPixelFormat();
+
 public:
     LFBgraphics(const LFBgraphics& copy) = delete;  // Verhindere Kopieren
 
@@ -46,11 +91,21 @@ public:
     void clear() const;
     void drawPixel(unsigned int x, unsigned int y, unsigned int col) const;
 
+    // Horizontale Linie ab (x, y) mit len Pixeln, wird am Bildrand abgeschnitten
+    void drawSpan(unsigned int x, unsigned int y, unsigned int len, unsigned int col) const;
+
     void drawString(const Font& fnt, unsigned int x, unsigned int y, unsigned int col, const char* str, unsigned int len) const;
 
+    // Like drawString but with background color, the whole line is clipped once and drawn from the glyph cache
+    void drawText(const Font& fnt, unsigned int x, unsigned int y, unsigned int fg, unsigned int bg, const char* str, unsigned int len) const;
+
+    // Frees the cached glyphs, e.g. when leaving the graphics mode
+    void flushGlyphs() const { glyphs.flush(); }
+
     void drawCircle(unsigned int x, unsigned int y, unsigned int rad, unsigned int col) const;
     void drawStraightLine(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, unsigned int col) const;
     void drawRectangle(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, unsigned int col) const;
+    void fillRectangle(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, unsigned int col) const;
 
     void drawSprite(unsigned int width, unsigned int height, unsigned int bytes_pp, const unsigned char* pixel_data) const;
 
@@ -59,6 +114,9 @@ public:
 
     // kopiert 'hfb' nach 'lfb'
     void copyHiddenToVisible() const;
+
+    // kopiert nur die seit dem letzten Aufruf veraenderten Bereiche von 'hfb' nach 'lfb'
+    void present() const;
 };
 
 #endif
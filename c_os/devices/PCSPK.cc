@@ -71,10 +71,8 @@ inline void PCSPK::delay(int time) {
 
     /* Hier muess Code eingefuegt werden */
 
-    unsigned long start_time = systime;
-
-    // systime is incremented in 10ms steps
-    while ((systime - start_time) * 10 < time) {}
+    // systime is incremented in 10ms steps, sleep instead of spinning so other threads can run
+    scheduler.sleep_for((time + 9) / 10);
 }
 
 /*****************************************************************************
@@ -34,6 +34,78 @@ void PIT::interval(int us) {
 
     data0.outb(cntStart & 0xFF);  // Zaehler-0 laden (Lobyte)
     data0.outb(cntStart >> 8);    // Zaehler-0 laden (Hibyte)
+
+    timer_interval = us;
+    tick_counts = cntStart;
+}
+
+/*****************************************************************************
+ * Methode:         PIT::tickless                                            *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Periodischen Interrupt abschalten und Zaehler 0 im       *
+ *                  Modus 0 (Interrupt bei Zaehlerende) programmieren.       *
+ *                                                                           *
+ * Parameter:                                                                *
+ *      ticks:      Anzahl Ticks bis zum naechsten Interrupt.                *
+ *****************************************************************************/
+void PIT::tickless(unsigned int ticks) {
+    if (ticks > max_tickless()) {
+        ticks = max_tickless();
+    }
+    if (ticks <= 1) {
+        return;  // Nothing to gain, keep the periodic tick
+    }
+
+    shot_counts = ticks * tick_counts;
+    one_shot = true;
+
+    control.outb(0x30);  // Zähler 0 Mode 0
+    data0.outb(shot_counts & 0xFF);
+    data0.outb(shot_counts >> 8);
+}
+
+/*****************************************************************************
+ * Methode:         PIT::wakeup                                              *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Wird bei jedem Interrupt ausser dem Zeitgeber aufgerufen.*
+ *                  Beendet einen laufenden One-Shot vorzeitig, rechnet die  *
+ *                  vergangene Zeit auf systime an und startet wieder den    *
+ *                  periodischen Interrupt.                                  *
+ *****************************************************************************/
+void PIT::wakeup() {
+    if (!one_shot) {
+        return;
+    }
+
+    bool expired;
+    unsigned int remaining = read_counter(expired);
+    if (expired) {
+        // The timer interrupt is already pending, trigger() accounts the whole one-shot
+        return;
+    }
+
+    account(shot_counts - remaining);
+    one_shot = false;
+    interval(timer_interval);
+}
+
+unsigned int PIT::read_counter(bool& expired) const {
+    control.outb(0xC2);  // Read-Back: Status und Zaehlerstand von Zaehler 0 latchen
+    unsigned int status = data0.inb();
+    unsigned int lo = data0.inb();
+    unsigned int hi = data0.inb();
+
+    expired = (status & 0x80) != 0;  // OUT goes high when mode 0 reaches 0
+    if ((status & 0x40) != 0) {
+        return shot_counts;  // Null count: The new start value isn't loaded yet
+    }
+    return lo | (hi << 8);
+}
+
+void PIT::account(unsigned int counts) {
+    leftover_counts += counts;
+    systime += leftover_counts / tick_counts;
+    leftover_counts %= tick_counts;
 }
 
 /*****************************************************************************
@@ -63,10 +135,22 @@ void PIT::trigger() {
 
     /* hier muss Code eingefuegt werden */
 
+    last_tsc = CPU::rdtsc();
+
+    // Has to happen before anything enables interrupts again
+    Profiler::sample();
+
     // log << TRACE << "Incrementing systime" << endl;
 
     // alle 10ms, Systemzeit weitersetzen
-    systime++;
+    if (one_shot) {
+        // End of tickless phase, the whole one-shot has elapsed
+        account(shot_counts);
+        one_shot = false;
+        interval(timer_interval);
+    } else {
+        systime++;
+    }
 
     // Bei jedem Tick einen Threadwechsel ausloesen.
     // Aber nur wenn der Scheduler bereits fertig intialisiert wurde
@@ -81,6 +165,9 @@ void PIT::trigger() {
         last_indicator_refresh = systime;
     }
 
+    // Sleeping threads become ready before the scheduler decides who runs next
+    scheduler.wakeup_sleepers(systime);
+
     // Preemption
     if (scheduler.preemption_enabled()) {
         // log << TRACE << "Preemption" << endl;
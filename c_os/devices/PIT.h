@@ -22,6 +22,19 @@ private:
 
     enum { time_base = 838 }; /* ns */
     int timer_interval;
+    unsigned int tick_counts;  // Counter start value for a single tick
+
+    // Tickless mode: While only the idle thread runs the periodic tick is replaced by a single
+    // interrupt (counter 0 mode 0), systime is then advanced by the counts that really elapsed
+    bool one_shot = false;
+    unsigned int shot_counts = 0;      // Start value of the running one-shot
+    unsigned int leftover_counts = 0;  // Elapsed counts that didn't add up to a full tick yet
+
+    unsigned long long last_tsc = 0;  // rdtsc at the last timer interrupt, for latency measurements
+
+    // Latches status and count of counter 0 together, expired is set if the one-shot has counted down
+    unsigned int read_counter(bool& expired) const;
+    void account(unsigned int counts);  // Advances systime by elapsed counts
 
     const bse::array<char, 4> indicator{'|', '/', '-', '\\'};
     unsigned int indicator_pos = 0;
@@ -37,12 +50,25 @@ public:
         PIT::interval(us);
     }
 
+    // Timestamp of the last timer interrupt
+    unsigned long long last_interrupt() const { return last_tsc; }
+
     // Konfiguriertes Zeitintervall auslesen.
     int interval() const { return timer_interval; }
 
     // Zeitintervall in Mikrosekunden, nachdem periodisch ein Interrupt
     //erzeugt werden soll.
-    static void interval(int us);
+    void interval(int us);
+
+    // Longest one-shot the 16 bit counter allows
+    unsigned int max_tickless() const { return 0xFFFF / tick_counts; }
+
+    // Stops the periodic tick, the next timer interrupt will come after 'ticks' ticks
+    // (clamped to max_tickless). Has to be called with interrupts disabled.
+    void tickless(unsigned int ticks);
+
+    // Restores the periodic tick if an interrupt ended the tickless phase early
+    void wakeup();
 
     // Aktivierung der Unterbrechungen fuer den Zeitgeber
     void plugin();
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ *                                                                           *
+ *                          P I X E L F O R M A T                            *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Pixelformate der Farbtiefen 8/15/16/24/32 Bit und die    *
+ *                  daraus pro Format erzeugten Zeichenroutinen.             *
+ *****************************************************************************/
+
+#ifndef PixelFormat_include__
+#define PixelFormat_include__
+
+#include "user/lib/mem/Memory.h"
+
+// NOTE: LFBgraphics used to switch on bpp for every single pixel. Now every format is a policy
+//       (bytes per pixel, how to convert a RGB_24 color, how to store a pixel) and the drawing loops
+//       are instantiated once per policy. The matching table of function pointers is selected once
+//       when the graphics mode is set, so the inner loops don't contain any branches on the format.
+//       The loops expect their spans to be clipped already.
+
+// 8 Bit modes use a palette, the color is the palette index
+struct PixelFormat8 {
+    static constexpr const unsigned int bytes = 1;
+    static unsigned int encode(unsigned int rgb) { return rgb & 0xFF; }
+    static void put(unsigned char* dst, unsigned int px) { *dst = px; }
+    static void fill(unsigned char* dst, unsigned int count, unsigned int px) { bse::memset(dst, static_cast<char>(px), count); }
+};
+
+// RGB 555
+struct PixelFormat15 {
+    static constexpr const unsigned int bytes = 2;
+    static unsigned int encode(unsigned int rgb) {
+        return ((rgb >> 9) & 0x7C00) | ((rgb >> 6) & 0x03E0) | ((rgb >> 3) & 0x001F);
+    }
+    static void put(unsigned char* dst, unsigned int px) { *reinterpret_cast<unsigned short*>(dst) = px; }
+    static void fill(unsigned char* dst, unsigned int count, unsigned int px) {
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(dst);
+        for (unsigned int i = 0; i < count; ++i) {
+            ptr[i] = px;
+        }
+    }
+};
+
+// RGB 565
+struct PixelFormat16 {
+    static constexpr const unsigned int bytes = 2;
+    static unsigned int encode(unsigned int rgb) {
+        return ((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F);
+    }
+    static void put(unsigned char* dst, unsigned int px) { *reinterpret_cast<unsigned short*>(dst) = px; }
+    static void fill(unsigned char* dst, unsigned int count, unsigned int px) { PixelFormat15::fill(dst, count, px); }
+};
+
+// BGR byte order in memory
+struct PixelFormat24 {
+    static constexpr const unsigned int bytes = 3;
+    static unsigned int encode(unsigned int rgb) { return rgb; }
+    static void put(unsigned char* dst, unsigned int px) {
+        dst[0] = px & 0xFF;
+        dst[1] = (px >> 8) & 0xFF;
+        dst[2] = (px >> 16) & 0xFF;
+    }
+    static void fill(unsigned char* dst, unsigned int count, unsigned int px) {
+        for (unsigned int i = 0; i < count; ++i) {
+            put(dst, px);
+            dst += 3;
+        }
+    }
+};
+
+struct PixelFormat32 {
+    static constexpr const unsigned int bytes = 4;
+    static unsigned int encode(unsigned int rgb) { return rgb; }
+    static void put(unsigned char* dst, unsigned int px) { *reinterpret_cast<unsigned int*>(dst) = px; }
+    static void fill(unsigned char* dst, unsigned int count, unsigned int px) {
+        bse::memset32(reinterpret_cast<unsigned int*>(dst), px, count);
+    }
+};
+
+// Drawing routines of one format, pixels are already encoded
+struct PixelOps {
+    unsigned int bytes;
+    unsigned int (*encode)(unsigned int rgb);
+    void (*pixel)(unsigned char* dst, unsigned int px);
+    void (*span)(unsigned char* dst, unsigned int count, unsigned int px);
+    void (*column)(unsigned char* dst, unsigned int count, unsigned int pitch, unsigned int px);
+
+    // One row of a monochrome bitmap, set bits get px, starting at bit 'skip' of the first byte
+    void (*mono_row)(unsigned char* dst, const unsigned char* bits, unsigned int skip, unsigned int count, unsigned int px);
+
+    // One row of a sprite with 2 (RGB 565), 3 or 4 (RGB(A)) bytes per pixel
+    void (*sprite_row)(unsigned char* dst, const unsigned char* src, unsigned int count, unsigned int src_bytes_pp);
+};
+
+template<typename F>
+struct PixelPipeline {
+    static void pixel(unsigned char* dst, unsigned int px) { F::put(dst, px); }
+
+    static void span(unsigned char* dst, unsigned int count, unsigned int px) { F::fill(dst, count, px); }
+
+    static void column(unsigned char* dst, unsigned int count, unsigned int pitch, unsigned int px) {
+        for (unsigned int i = 0; i < count; ++i) {
+            F::put(dst, px);
+            dst += pitch;
+        }
+    }
+
+    static void mono_row(unsigned char* dst, const unsigned char* bits, unsigned int skip, unsigned int count, unsigned int px) {
+        bits += skip / 8;
+        unsigned char mask = 0x80 >> (skip % 8);
+        for (unsigned int i = 0; i < count; ++i) {
+            if (*bits & mask) {
+                F::put(dst, px);
+            }
+            dst += F::bytes;
+            mask >>= 1;
+            if (mask == 0) {
+                mask = 0x80;
+                ++bits;
+            }
+        }
+    }
+
+    static void sprite_row(unsigned char* dst, const unsigned char* src, unsigned int count, unsigned int src_bytes_pp) {
+        // Branch once per row on the source format
+        if (src_bytes_pp == 2) {
+            // TODO: Never tested, probably doesn't work
+            for (unsigned int i = 0; i < count; ++i) {
+                unsigned int rgb = ((src[0] & 0b11111000) << 16) | ((((src[0] & 0b111) << 3) | (src[1] >> 5)) << 8) | (src[1] & 0b11111);
+                F::put(dst, F::encode(rgb));
+                dst += F::bytes;
+                src += 2;
+            }
+        } else {
+            // Alpha gets ignored anyway
+            for (unsigned int i = 0; i < count; ++i) {
+                F::put(dst, F::encode((src[0] << 16) | (src[1] << 8) | src[2]));
+                dst += F::bytes;
+                src += src_bytes_pp;
+            }
+        }
+    }
+
+    static constexpr const PixelOps ops = {F::bytes, F::encode, pixel, span, column, mono_row, sprite_row};
+};
+
+#endif
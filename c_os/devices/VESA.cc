@@ -118,7 +118,9 @@ bool VESA::initGraphicMode(unsigned short mode) {
             bpp = static_cast<int>(minf->bpp);
             lfb = minf->physbase;
 
-            hfb = reinterpret_cast<unsigned int>(new char[xres * yres * bpp / 8]);
+            hfb = reinterpret_cast<unsigned int>(new char[xres * yres * bytesPerPixel()]);
+            discardDirty();
+            selectPixelFormat();
 
             // Grafikmodus einschalten
             BC_params->AX = 0x4f02;  // SVFA BIOS, init mode
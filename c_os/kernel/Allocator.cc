@@ -33,6 +33,7 @@
 
 #include "kernel/Allocator.h"
 #include "kernel/Globals.h"
+#include "user/lib/mem/Memory.h"
 
 constexpr const unsigned int MEM_SIZE_DEF = 8 * 1024 * 1024;  // Groesse des Speichers = 8 MB
 constexpr const unsigned int HEAP_START = 0x300000;    // Startadresse des Heaps
@@ -48,33 +49,72 @@ Allocator::Allocator() : heap_start(HEAP_START), heap_end(HEAP_START + HEAP_SIZE
     total_mem = MEM_SIZE_DEF;
 }
 
+/*****************************************************************************
+ * Methode:         Allocator::realloc                                       *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Blockgroesse aendern. Zuerst wird versucht den Block an  *
+ *                  Ort und Stelle zu vergroessern, ansonsten wird ein neuer *
+ *                  Block angelegt und der Inhalt kopiert.                   *
+ *****************************************************************************/
+void* Allocator::realloc(void* ptr, unsigned int old_size, unsigned int req_size) {
+    if (ptr == nullptr) {
+        return alloc(req_size);
+    }
+    if (try_expand_in_place(ptr, req_size)) {
+        return ptr;
+    }
+
+    void* moved = alloc(req_size);
+    if (moved == nullptr) {
+        return nullptr;
+    }
+    bse::memcpy(static_cast<char*>(moved), static_cast<char*>(ptr), old_size < req_size ? old_size : req_size);
+    free(ptr);
+    return moved;
+}
+
+bool try_expand_in_place(void* ptr, unsigned int req_size) {
+    return slab.try_expand_in_place(ptr, req_size);
+}
+
 /*****************************************************************************
  * Nachfolgend sind die Operatoren von C++, die wir hier ueberschreiben      *
  * und entsprechend 'mm_alloc' und 'mm_free' aufrufen.                       *
+ *                                                                           *
+ * Kleine Objekte werden vom SlabAllocator bedient, dieser gibt alles andere *
+ * an 'allocator' weiter.                                                    *
  *****************************************************************************/
 void* operator new(std::size_t size) {
-    return allocator.alloc(size);
+    void* ptr = slab.alloc(size);
+    Trace::event(Trace::ALLOC, reinterpret_cast<unsigned int>(ptr), size);
+    return ptr;
 }
 
 void* operator new[](std::size_t count) {
-    return allocator.alloc(count);
+    void* ptr = slab.alloc(count);
+    Trace::event(Trace::ALLOC, reinterpret_cast<unsigned int>(ptr), count);
+    return ptr;
 }
 
 void operator delete(void* ptr) {
-    allocator.free(ptr);
+    Trace::event(Trace::FREE, reinterpret_cast<unsigned int>(ptr));
+    slab.free(ptr);
 }
 
 void operator delete[](void* ptr) {
-    allocator.free(ptr);
+    Trace::event(Trace::FREE, reinterpret_cast<unsigned int>(ptr));
+    slab.free(ptr);
 }
 
 void operator delete(void* ptr, unsigned int sz) {
-    allocator.free(ptr);
+    Trace::event(Trace::FREE, reinterpret_cast<unsigned int>(ptr));
+    slab.free(ptr);
 }
 
 // I don't know if accidentally deleted it but one delete was missing
 // https://en.cppreference.com/w/cpp/memory/new/operator_delete
 
 void operator delete[](void* ptr, unsigned int sz) {
-    allocator.free(ptr);
+    Trace::event(Trace::FREE, reinterpret_cast<unsigned int>(ptr));
+    slab.free(ptr);
 }
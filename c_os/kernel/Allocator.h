@@ -53,6 +53,18 @@ public:
     virtual void dump_free_memory() = 0;
     virtual void* alloc(unsigned int req_size) = 0;
     virtual void free(void* ptr) = 0;
+
+    // Resizes the block at ptr to at least req_size bytes without moving it (shrinking always works).
+    // Allocators that can't do this just return false.
+    virtual bool try_expand_in_place(void* ptr, unsigned int req_size) { return false; }
+
+    // Resizes the block, moves it if it can't be resized in place (old_size bytes are kept).
+    // Returns nullptr if no memory is left, the old block stays valid then.
+    void* realloc(void* ptr, unsigned int old_size, unsigned int req_size);
 };
 
+// Counterpart to operator new for containers that want to grow their buffer without moving it,
+// goes through the same allocators as new/delete
+bool try_expand_in_place(void* ptr, unsigned int req_size);
+
 #endif
@@ -28,6 +28,26 @@ public:
         asm volatile("cli");
     }
 
+    // Interrupts verbieten und den vorherigen Zustand (EFLAGS) zurueckgeben,
+    // fuer Code der auch mit bereits gesperrten Interrupts aufgerufen wird
+    static inline unsigned int save_and_disable_int() {
+        unsigned int flags;
+        asm volatile("pushf;"
+                     "pop %0;"
+                     "cli"
+                     : "=r"(flags)
+                     :
+                     : "memory");
+        return flags;
+    }
+
+    // Interrupts nur wieder erlauben, wenn sie vor save_and_disable_int() erlaubt waren
+    static inline void restore_int(unsigned int flags) {
+        if (flags & 0x200) {  // Interrupt-Flag
+            asm volatile("sti");
+        }
+    }
+
     // Prozessor bis zum naechsten Interrupt anhalten
     static inline void idle() {
         asm volatile("sti;"
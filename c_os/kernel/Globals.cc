@@ -23,7 +23,9 @@ Keyboard kb;           // Tastatur
 // BumpAllocator allocator;
 LinkedListAllocator allocator;
 // TreeAllocator allocator;
+SlabAllocator slab(allocator);
 
+StackPool stackpool;
 Scheduler scheduler;
 
 KeyEventManager kevman;
@@ -17,13 +17,18 @@
 #include "devices/VESA.h"
 #include "kernel/allocator/BumpAllocator.h"
 #include "kernel/allocator/LinkedListAllocator.h"
+#include "kernel/allocator/SlabAllocator.h"
 #include "kernel/allocator/TreeAllocator.h"
 #include "kernel/BIOS.h"
 #include "kernel/CPU.h"
 #include "kernel/interrupts/IntDispatcher.h"
 #include "kernel/interrupts/PIC.h"
+#include "kernel/interrupts/StackGuard.h"
 #include "kernel/Paging.h"
+#include "kernel/Profiler.h"
+#include "kernel/Trace.h"
 #include "kernel/threads/Scheduler.h"
+#include "kernel/threads/StackPool.h"
 #include "user/devices/SerialOut.h"
 #include "user/event/KeyEventManager.h"
 
@@ -42,7 +47,9 @@ extern Keyboard kb;           // Tastatur
 // extern BumpAllocator allocator;
 extern LinkedListAllocator allocator;
 // extern TreeAllocator allocator;
+extern SlabAllocator slab;  // Kleine Objekte, alles andere geht an allocator
 
+extern StackPool stackpool;  // Thread-Stacks, Seiten vom Paging
 extern Scheduler scheduler;
 
 extern KeyEventManager kevman;
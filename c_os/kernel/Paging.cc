@@ -82,7 +82,7 @@ unsigned int* pg_alloc_page() {
     // 1. Eintrag ist fuer Null-Pointer-Exception reserviert
     // ausserdem liegt an die Page-Table an Adresse PAGE_TABLE
     // somit ist est PAGE_TABLE + 4 KB frei (bis max. 3 MB, da beginnt der Heap)
-    for (int i = 1; i < 1024; i++) {
+    for (unsigned int i = 1; i <= (LST_ALLOCABLE_PAGE >> 12); i++) {
         p_page++;
         // pruefe ob Page frei
         if (((*p_page) & PAGE_RESERVED) == 0) {
@@ -93,6 +93,38 @@ unsigned int* pg_alloc_page() {
     return nullptr;
 }
 
+/*****************************************************************************
+ * Funktion:        pg_alloc_pages                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Alloziert n zusammenhaengende 4 KB Seiten (first fit).   *
+ *                  Wird z.B. fuer Thread-Stacks verwendet.                  *
+ *****************************************************************************/
+unsigned int* pg_alloc_pages(unsigned int n) {
+    unsigned int* p_table = reinterpret_cast<unsigned int*>(PAGE_TABLE);
+    constexpr const unsigned int first = FST_ALLOCABLE_PAGE >> 12;
+    constexpr const unsigned int last = LST_ALLOCABLE_PAGE >> 12;  // Above this is the heap
+
+    if (n == 0) {
+        return nullptr;
+    }
+
+    unsigned int run = 0;  // Free pages in a row ending at i
+    for (unsigned int i = first; i <= last; ++i) {
+        if ((p_table[i] & PAGE_RESERVED) != 0) {
+            run = 0;
+            continue;
+        }
+        if (++run == n) {
+            unsigned int start = i + 1 - n;
+            for (unsigned int j = start; j <= i; ++j) {
+                p_table[j] = p_table[j] | PAGE_RESERVED;
+            }
+            return reinterpret_cast<unsigned int*>(start << 12);
+        }
+    }
+    return nullptr;
+}
+
 /*****************************************************************************
  * Funktion:        pg_write_protect_page                                    *
  *---------------------------------------------------------------------------*
@@ -149,6 +181,12 @@ void pg_free_page(unsigned int* p_page) {
     *p_page = ((idx << 12) | PAGE_WRITEABLE | PAGE_PRESENT);
 }
 
+void pg_free_pages(unsigned int* p_page, unsigned int n) {
+    for (unsigned int i = 0; i < n; ++i) {
+        pg_free_page(p_page + i * 1024);
+    }
+}
+
 /*****************************************************************************
  * Funktion:        pg_init                                                  *
  *---------------------------------------------------------------------------*
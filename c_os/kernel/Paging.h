@@ -64,6 +64,9 @@ extern void pg_init();
 // alloziert eine 4 KB Page
 extern unsigned int* pg_alloc_page();
 
+// alloziert n zusammenhaengende 4 KB Pages
+extern unsigned int* pg_alloc_pages(unsigned int n);
+
 // Schreibschutz auf Seite setzen -> fuer debugging nuetzlich
 extern void pg_write_protect_page(const unsigned int* p_page);
 
@@ -73,4 +76,7 @@ extern void pg_notpresent_page(const unsigned int* p_page);
 // gibt eine 4 KB Page frei
 extern void pg_free_page(unsigned int* p_page);
 
+// gibt n mit pg_alloc_pages allozierte Pages frei
+extern void pg_free_pages(unsigned int* p_page, unsigned int n);
+
 #endif
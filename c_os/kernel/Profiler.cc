@@ -0,0 +1,105 @@
+#include "kernel/Profiler.h"
+#include "kernel/Globals.h"
+
+extern "C" {
+    void get_int_esp(unsigned int** esp);
+}
+
+Profiler::sample_t Profiler::samples[Profiler::SIZE];
+unsigned int Profiler::total = 0;
+unsigned int Profiler::lost = 0;
+bool Profiler::enabled = false;
+
+// Writes the number as 8 hex digits (without 0x)
+void write_hex(unsigned int value) {
+    constexpr const char* digits = "0123456789abcdef";
+    char text[8];
+
+    for (int i = 7; i >= 0; --i) {
+        text[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    SerialOut::write(bse::string_view(text, 8));
+}
+
+void Profiler::start() {
+    CPU::disable_int();
+    for (sample_t& s : samples) {
+        s.count = 0;
+    }
+    total = 0;
+    lost = 0;
+    enabled = true;
+    CPU::enable_int();
+}
+
+/*****************************************************************************
+ * Methode:         Profiler::sample                                         *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Unterbrochene Adresse zaehlen. Muss aufgerufen werden    *
+ *                  bevor Interrupts wieder erlaubt werden, da int_esp sonst *
+ *                  von einer weiteren Unterbrechung ueberschrieben wird.    *
+ *****************************************************************************/
+void Profiler::sample() {
+    if (!enabled) {
+        return;
+    }
+
+    // Stack-Layout siehe Bluescreen.cc, EIP liegt direkt ueber den von pushad gesicherten Registern
+    unsigned int* int_esp;
+    get_int_esp(&int_esp);
+    unsigned int eip = *(reinterpret_cast<unsigned int*>(*int_esp) + 8);
+    unsigned int tid = scheduler.preemption_enabled() ? scheduler.get_active() : 0;
+
+    ++total;
+    unsigned int slot = ((eip >> 2) ^ (tid * 0x9E3779B1U)) & (SIZE - 1);
+    for (unsigned int i = 0; i < MAX_PROBES; ++i) {
+        sample_t& s = samples[(slot + i) & (SIZE - 1)];
+        if (s.count == 0) {
+            s.eip = eip;
+            s.tid = tid;
+            s.count = 1;
+            return;
+        }
+        if (s.eip == eip && s.tid == tid) {
+            ++s.count;
+            return;
+        }
+    }
+    ++lost;
+}
+
+/*****************************************************************************
+ * Methode:         Profiler::dump                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Histogramm zeilenweise ("<eip> <tid> <anzahl>", hex)     *
+ *                  ueber die serielle Schnittstelle ausgeben.               *
+ *****************************************************************************/
+void Profiler::dump() {
+    bool was_enabled = enabled;
+    enabled = false;  // The histogram must not change while it is written
+
+    SerialOut::write("\r\nPROFILE-BEGIN ");
+    write_hex(total);
+    SerialOut::write(' ');
+    write_hex(lost);
+    SerialOut::write("\r\n");
+
+    for (const sample_t& s : samples) {
+        if (s.count == 0) {
+            continue;
+        }
+        write_hex(s.eip);
+        SerialOut::write(' ');
+        write_hex(s.tid);
+        SerialOut::write(' ');
+        write_hex(s.count);
+        SerialOut::write("\r\n");
+    }
+
+    SerialOut::write("PROFILE-END\r\n");
+
+    kout << "Profile: " << dec << total << " samples (" << lost << " lost) written to serial" << endl;
+
+    enabled = was_enabled;
+}
@@ -0,0 +1,50 @@
+/*****************************************************************************
+ *                                                                           *
+ *                              P R O F I L E R                              *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Stichprobenbasierter Profiler. Bei jeder Unterbrechung   *
+ *                  des PIT wird die unterbrochene Adresse (EIP) zusammen    *
+ *                  mit dem aktiven Thread gezaehlt. Das Ergebnis wird ueber *
+ *                  die serielle Schnittstelle ausgegeben und auf dem Host   *
+ *                  mit tools/profile.sh den Funktionen zugeordnet.          *
+ *****************************************************************************/
+
+#ifndef Profiler_include__
+#define Profiler_include__
+
+// NOTE: Samples are taken at the PIT rate (every 10ms), the idle thread is underrepresented because
+//       the timer is stopped while it runs tickless.
+class Profiler {
+private:
+    struct sample_t {
+        unsigned int eip;
+        unsigned int tid;
+        unsigned int count;  // 0 if the slot is unused
+    };
+
+    static constexpr const unsigned int SIZE = 1024;  // Power of 2
+    static constexpr const unsigned int MAX_PROBES = 16;
+
+    // Open addressing with linear probing, no allocation in the interrupt handler
+    static sample_t samples[SIZE];
+    static unsigned int total;
+    static unsigned int lost;  // Samples that didn't find a free slot
+    static bool enabled;
+
+public:
+    Profiler(const Profiler& copy) = delete;
+
+    // Clears the histogram and starts sampling
+    static void start();
+    static void stop() { enabled = false; }
+    static bool running() { return enabled; }
+
+    // Called from the PIT interrupt handler
+    static void sample();
+
+    // Writes the histogram to the serial port, enclosed in PROFILE-BEGIN/PROFILE-END lines
+    static void dump();
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "kernel/Trace.h"
+#include "kernel/Globals.h"
+
+const IOport Trace::com2(0x2f8);
+
+Trace::record Trace::ring[Trace::SIZE];
+unsigned int Trace::head = 0;
+unsigned int Trace::tail = 0;
+unsigned int Trace::dropped = 0;
+bool Trace::enabled = false;
+
+/*****************************************************************************
+ * Methode:         Trace::start                                             *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    COM2 initialisieren und die Aufzeichnung starten.        *
+ *****************************************************************************/
+void Trace::start() {
+    com2.outb(1, 0x00);  // Disable all interrupts, the port is polled
+    com2.outb(3, 0x80);  // Enable DLAB (set baud rate divisor)
+    com2.outb(0x01);     // Set divisor to 1 (lo byte) 115200 baud
+    com2.outb(1, 0x00);  //                  (hi byte)
+    com2.outb(3, 0x03);  // 8 bits, no parity, one stop bit
+    com2.outb(2, 0xC7);  // Enable FIFO, clear them, with 14-byte threshold
+    com2.outb(4, 0x03);  // RTS/DSR set
+
+    enabled = true;
+    event(CLOCK, systime);
+}
+
+void Trace::stop() {
+    event(CLOCK, systime);
+    enabled = false;
+}
+
+/*****************************************************************************
+ * Methode:         Trace::record_event                                      *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Ereignis in den Ring eintragen. Wird auch aus Interrupt- *
+ *                  Handlern gerufen, daher werden die Interrupts kurz       *
+ *                  gesperrt.                                                *
+ *****************************************************************************/
+void Trace::record_event(Event event, unsigned int arg0, unsigned int arg1) {
+    unsigned int flags = CPU::save_and_disable_int();
+
+    // Threads only exist after the scheduler was started
+    unsigned int tid = scheduler.preemption_enabled() ? scheduler.get_active() : 0;
+
+    unsigned long long tsc = CPU::rdtsc();
+
+    // Report lost records first, so the gap is visible in the timeline
+    if (dropped > 0 && put({MAGIC, DROPPED, tid, tsc, dropped, 0})) {
+        dropped = 0;
+    }
+    if (dropped > 0 || !put({MAGIC, event, tid, tsc, arg0, arg1})) {
+        ++dropped;
+    }
+
+    CPU::restore_int(flags);
+}
+
+bool Trace::put(const record& rec) {
+    unsigned int next = (head + 1) & (SIZE - 1);
+    if (next == tail) {
+        return false;
+    }
+    ring[head] = rec;
+    head = next;
+    return true;
+}
+
+void Trace::send(const record& rec) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&rec);
+    for (unsigned int i = 0; i < sizeof(record); ++i) {
+        while ((com2.inb(5) & 0x20) == 0) {}
+        com2.outb(bytes[i]);
+    }
+}
+
+/*****************************************************************************
+ * Methode:         Trace::drain                                             *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Aufgezeichnete Ereignisse ueber COM2 senden. Die         *
+ *                  Interrupts sind nur beim Entnehmen gesperrt.             *
+ *****************************************************************************/
+void Trace::drain() {
+    if (!enabled && head == tail) {
+        return;
+    }
+
+    // Every drain provides a reference point for converting the timestamps
+    event(CLOCK, systime);
+
+    record rec;
+    while (true) {
+        CPU::disable_int();
+        if (tail == head) {
+            CPU::enable_int();
+            break;
+        }
+        rec = ring[tail];
+        tail = (tail + 1) & (SIZE - 1);
+        CPU::enable_int();
+
+        send(rec);
+    }
+}
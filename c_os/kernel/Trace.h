@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *                                                                           *
+ *                                 T R A C E                                 *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Binaere Ereignisaufzeichnung (Threadwechsel, Interrupts, *
+ *                  Speicheranforderungen, Semaphore) ueber COM2.            *
+ *                  Die Aufzeichnung wird auf dem Host mit                   *
+ *                  tools/tracedecode in das Chrome-Trace-Format umgewandelt.*
+ *****************************************************************************/
+
+#ifndef Trace_include__
+#define Trace_include__
+
+#include "kernel/CPU.h"
+#include "kernel/IOport.h"
+
+// Trace points can be removed from the kernel completely
+constexpr const bool TRACE_POINTS = true;
+
+// NOTE: Formatting text in the scheduler or in interrupt handlers is way too slow (and would change the
+//       timing that should be observed), so trace points only store a fixed size record in a static ring.
+//       The LogDrainThread sends the records over COM2 where qemu writes them to a file (make qemu-trace).
+//       The layout is shared with tools/tracedecode.c.
+class Trace {
+public:
+    enum Event : unsigned short {
+        CLOCK = 1,      // arg0: systime, used by the decoder to convert the timestamps
+        SWITCH = 2,     // arg0: previous tid, arg1: next tid
+        IRQ_ENTER = 3,  // arg0: vector
+        IRQ_EXIT = 4,   // arg0: vector
+        ALLOC = 5,      // arg0: address, arg1: size
+        FREE = 6,       // arg0: address
+        SEM_P = 7,      // arg0: semaphore, arg1: 1 if the thread blocked
+        SEM_V = 8,      // arg0: semaphore, arg1: tid of the woken thread or 0
+        DROPPED = 9     // arg0: number of records lost because the ring was full
+    };
+
+    static constexpr const unsigned short MAGIC = 0x5254;  // "TR", to resynchronize after lost bytes
+
+    struct record {
+        unsigned short magic;
+        unsigned short event;
+        unsigned int tid;
+        unsigned long long tsc;
+        unsigned int arg0;
+        unsigned int arg1;
+    } __attribute__((packed));
+
+private:
+    static constexpr const unsigned int SIZE = 1024;  // Power of 2
+
+    static const IOport com2;
+
+    static record ring[SIZE];
+    static unsigned int head;  // Next record to write
+    static unsigned int tail;  // Next record to send
+    static unsigned int dropped;
+    static bool enabled;
+
+    static void record_event(Event event, unsigned int arg0, unsigned int arg1);
+    static bool put(const record& rec);  // False if the ring is full
+    static void send(const record& rec);
+
+public:
+    Trace(const Trace& copy) = delete;
+
+    // Initializes COM2 and starts recording
+    static void start();
+    static void stop();
+    static bool running() { return enabled; }
+
+    static void event(Event event, unsigned int arg0 = 0, unsigned int arg1 = 0) {
+        if constexpr (TRACE_POINTS) {
+            if (enabled) {
+                record_event(event, arg0, arg1);
+            }
+        }
+    }
+
+    // Sends all recorded events, only called by the LogDrainThread
+    static void drain();
+};
+
+#endif
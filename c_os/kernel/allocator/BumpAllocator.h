@@ -15,7 +15,7 @@
 #include "kernel/Allocator.h"
 #include "user/lib/utility/Logger.h"
 
-class BumpAllocator : Allocator {
+class BumpAllocator : public Allocator {
 private:
     unsigned char* next;
     unsigned int allocations;
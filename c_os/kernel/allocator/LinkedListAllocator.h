@@ -29,7 +29,7 @@ typedef struct free_block {
     struct free_block* next;
 } free_block_t;
 
-class LinkedListAllocator : Allocator {
+class LinkedListAllocator : public Allocator {
 private:
     // freie Bloecke werden verkettet
     struct free_block* free_start = nullptr;
@@ -39,7 +39,8 @@ private:
     // aren't reachable from the freelist.
     static struct free_block* find_previous_block(struct free_block*);
 
-    NamedLogger log;
+    // Traces for every allocation, only compiled in when debugging the allocator
+    BasicNamedLogger<Logger::ERROR> log;
     SpinLock lock;
 
 public:
@@ -0,0 +1,138 @@
+/*****************************************************************************
+ *                                                                           *
+ *                         S L A B A L L O C A T O R                         *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Vorgeschaltete Speicherverwaltung fuer kleine Objekte.   *
+ *****************************************************************************/
+
+#include "kernel/allocator/SlabAllocator.h"
+#include "kernel/Globals.h"
+
+unsigned int SlabAllocator::class_of(unsigned int size) {
+    unsigned int cls = 0;
+    while (class_size(cls) < size) {
+        ++cls;
+    }
+    return cls;
+}
+
+SlabAllocator::region* SlabAllocator::region_of(const void* ptr) {
+    unsigned int addr = reinterpret_cast<unsigned int>(ptr);
+
+    // Regions are only appended, so the ones below region_count can be read without the lock
+    for (unsigned int i = 0; i < region_count; ++i) {
+        if (addr >= regions[i].start && addr < regions[i].start + REGION_PAGES * PAGE_SIZE) {
+            return &regions[i];
+        }
+    }
+    return nullptr;
+}
+
+bool SlabAllocator::refill(unsigned int cls) {
+    region_lock.acquire();
+
+    if (region_count == 0 || regions[region_count - 1].used_pages == REGION_PAGES) {
+        if (region_count == MAX_REGIONS) {
+            region_lock.release();
+            return false;
+        }
+
+        // The backing allocator doesn't align, so request an additional page to align the region
+        void* mem = backend.alloc(REGION_PAGES * PAGE_SIZE + PAGE_SIZE);
+        if (mem == nullptr) {
+            region_lock.release();
+            return false;
+        }
+
+        region& fresh = regions[region_count];
+        fresh.start = (reinterpret_cast<unsigned int>(mem) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        fresh.used_pages = 0;
+        ++region_count;  // Publish after the region is set up
+
+        log.info() << "New region at " << hex << fresh.start << endl;
+    }
+
+    region& reg = regions[region_count - 1];
+    unsigned int page = reg.start + reg.used_pages * PAGE_SIZE;
+    reg.page_class[reg.used_pages] = cls;
+    ++reg.used_pages;
+
+    region_lock.release();
+
+    // Cut the page into objects, caller holds the class lock
+    size_class& sc = classes[cls];
+    unsigned int size = class_size(cls);
+    for (unsigned int addr = page; addr + size <= page + PAGE_SIZE; addr += size) {
+        free_object* obj = reinterpret_cast<free_object*>(addr);
+        obj->next = sc.free_list;
+        sc.free_list = obj;
+    }
+    ++sc.pages;
+
+    return true;
+}
+
+void* SlabAllocator::alloc(unsigned int req_size) {
+    if (req_size > MAX_SIZE) {
+        return backend.alloc(req_size);
+    }
+
+    unsigned int cls = class_of(req_size);
+    size_class& sc = classes[cls];
+    sc.lock.acquire();
+
+    if (sc.free_list == nullptr && !refill(cls)) {
+        sc.lock.release();
+        log.debug() << "No pages left, using backing allocator" << endl;
+        return backend.alloc(req_size);
+    }
+
+    free_object* obj = sc.free_list;
+    sc.free_list = obj->next;
+
+    sc.lock.release();
+    return obj;
+}
+
+void SlabAllocator::free(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    region* reg = region_of(ptr);
+    if (reg == nullptr) {
+        backend.free(ptr);
+        return;
+    }
+
+    unsigned int page = (reinterpret_cast<unsigned int>(ptr) - reg->start) / PAGE_SIZE;
+    size_class& sc = classes[reg->page_class[page]];
+
+    sc.lock.acquire();
+    free_object* obj = static_cast<free_object*>(ptr);
+    obj->next = sc.free_list;
+    sc.free_list = obj;
+    sc.lock.release();
+}
+
+bool SlabAllocator::try_expand_in_place(void* ptr, unsigned int req_size) {
+    if (ptr == nullptr) {
+        return false;
+    }
+
+    region* reg = region_of(ptr);
+    if (reg == nullptr) {
+        return backend.try_expand_in_place(ptr, req_size);
+    }
+
+    unsigned int page = (reinterpret_cast<unsigned int>(ptr) - reg->start) / PAGE_SIZE;
+    return req_size <= class_size(reg->page_class[page]);
+}
+
+void SlabAllocator::dump_stats() {
+    kout << "Slab: " << dec << region_count << " Regionen" << endl;
+    for (unsigned int cls = 0; cls < CLASSES; ++cls) {
+        kout << " - " << dec << class_size(cls) << " Byte: " << classes[cls].pages << " Seiten" << endl;
+    }
+}
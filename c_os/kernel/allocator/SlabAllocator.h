@@ -0,0 +1,82 @@
+/*****************************************************************************
+ *                                                                           *
+ *                         S L A B A L L O C A T O R                         *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Vorgeschaltete Speicherverwaltung fuer kleine Objekte.   *
+ *                  Anfragen bis 2048 Byte werden auf Groessenklassen        *
+ *                  gerundet und aus 4 KiB Seiten bedient, die vom eigent-   *
+ *                  lichen Allocator in groesseren Regionen geholt werden.   *
+ *                  Groessere Anfragen gehen direkt an den Allocator.        *
+ *****************************************************************************/
+
+#ifndef SlabAllocator_include__
+#define SlabAllocator_include__
+
+#include "kernel/Allocator.h"
+#include "lib/SpinLock.h"
+#include "user/lib/Array.h"
+#include "user/lib/utility/Logger.h"
+
+// NOTE: Every page belongs to a single size class and is cut into equally sized objects, the free
+//       objects of a class are chained through their first word. Allocating and freeing is just
+//       popping/pushing that list. Freed pointers are recognized by checking if they lie inside
+//       one of the regions, the class of the page is stored in a per-region table.
+//       Pages are never handed back to the backing allocator.
+class SlabAllocator {
+public:
+    static constexpr const unsigned int PAGE_SIZE = 4096;
+    static constexpr const unsigned int MIN_SIZE = 8;
+    static constexpr const unsigned int MAX_SIZE = 2048;
+    static constexpr const unsigned int CLASSES = 9;  // 8, 16, ..., 2048
+
+    static constexpr const unsigned int REGION_PAGES = 16;  // 64 KiB per region
+    static constexpr const unsigned int MAX_REGIONS = 8;
+
+private:
+    struct free_object {
+        free_object* next;
+    };
+
+    struct size_class {
+        SpinLock lock;
+        free_object* free_list = nullptr;
+        unsigned int pages = 0;
+    };
+
+    struct region {
+        unsigned int start = 0;  // Page aligned
+        unsigned int used_pages = 0;
+        bse::array<unsigned char, REGION_PAGES> page_class;
+    };
+
+    Allocator& backend;
+    NamedLogger log;
+
+    bse::array<size_class, CLASSES> classes;
+
+    SpinLock region_lock;
+    bse::array<region, MAX_REGIONS> regions;
+    unsigned int region_count = 0;
+
+    static unsigned int class_of(unsigned int size);
+    static unsigned int class_size(unsigned int cls) { return MIN_SIZE << cls; }
+
+    region* region_of(const void* ptr);  // nullptr if not managed by the slab
+    bool refill(unsigned int cls);       // Cuts a new page into objects of this class
+
+public:
+    SlabAllocator(const SlabAllocator& copy) = delete;
+
+    explicit SlabAllocator(Allocator& backend) : backend(backend), log("SLAB") {}
+
+    void* alloc(unsigned int req_size);
+    void free(void* ptr);
+
+    // Objects can grow up to their class size, everything else is up to the backing allocator
+    bool try_expand_in_place(void* ptr, unsigned int req_size);
+
+    void dump_stats();
+};
+
+#endif
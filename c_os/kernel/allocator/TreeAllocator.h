@@ -2,10 +2,9 @@
 #define TreeAllocator_include__
 
 #include "kernel/Allocator.h"
+#include "lib/SpinLock.h"
 #include "user/lib/utility/Logger.h"
 
-// I can't imagine that this is fast with all the tree logic?
-
 typedef struct list_block {
     // Doubly linked list for every block
     bool allocated;
@@ -18,6 +17,7 @@ typedef struct list_block {
 // Because the red-black tree only contains the free blocks, the memory overhead comes
 // down to 4 + 4 + 4 Bytes for the allocated flag, next and previous pointers.
 // The size can be calculated by using the next pointer so it doesn't have to be stored.
+// The list is circular, so only neighbours that also lie next to each other in memory are merged.
 typedef struct tree_block {
     // Doubly linked list for every block
     // Locate this at the beginning so we can just cast to allocated_block_t and overwrite the rbt data
@@ -31,19 +31,25 @@ typedef struct tree_block {
     bool red;  //  RB tree node color
 } tree_block_t;
 
-class TreeAllocator : Allocator {
+class TreeAllocator : public Allocator {
 private:
     // Root of the rbt
     tree_block_t* free_start;
 
     NamedLogger log;
+    SpinLock lock;
+
+    // Usable size that is reserved for a request: Word aligned and large enough to store
+    // the rbt metadata when the block is freed again
+    static unsigned int round_size(unsigned int req_size);
+
+    // Splits the unused end of an allocated block into a new free block if it's large enough
+    void cut(list_block_t* block, unsigned int rreq_size);
 
     // Returns the size of the usable memory of a block
     unsigned int get_size(list_block_t* block) const;
     unsigned int get_size(tree_block_t* block) const { return get_size(reinterpret_cast<list_block_t*>(block)); }
 
-    void dump_free_memory(tree_block_t* node);
-
     // NOTE: Would be nice to have this stuff somewhere else for general use (scheduling?),
     //       makes no sense to have this as members. I'll move it later
     void rbt_rot_l(tree_block_t* x);
@@ -54,10 +60,13 @@ private:
     void rbt_insert(tree_block_t* node);
     void rbt_fix_insert(tree_block_t* k);
     void rbt_remove(tree_block_t* z);
-    void rbt_fix_remove(tree_block_t* x);
+    void rbt_fix_remove(tree_block_t* x, tree_block_t* parent);  // x can be a nullptr leaf, so pass the parent
+
+    // Leafs are nullptrs and count as black
+    static bool rbt_is_red(const tree_block_t* node) { return node != nullptr && node->red; }
 
-    tree_block_t* rbt_search_bestfit(tree_block_t* node, unsigned int req_size);
-    tree_block_t* rbt_search_bestfit(unsigned int req_size) { return rbt_search_bestfit(free_start, req_size); }
+    // Smallest free block with at least req_size bytes, nullptr if none is large enough
+    tree_block_t* rbt_search_bestfit(unsigned int req_size);
 
     void dll_insert(list_block_t* previous, list_block_t* node);
     void dll_insert(tree_block_t* previous, tree_block_t* node) {
@@ -76,6 +85,9 @@ public:
     void dump_free_memory() override;
     void* alloc(unsigned int req_size) override;
     void free(void* ptr) override;
+
+    // Grows the block into the following block if that one is free
+    bool try_expand_in_place(void* ptr, unsigned int req_size) override;
 };
 
 #endif
@@ -1,6 +1,9 @@
 #include "kernel/allocator/TreeAllocator.h"
 
 // RBT code taken from https://github.com/Bibeknam/algorithmtutorprograms
+// NOTE: The original code uses a sentinel node for the leafs, here the leafs are nullptrs.
+//       Every access to a node that can be a leaf has to go through rbt_is_red or check for nullptr,
+//       the removal fixup gets the parent passed separately as a nullptr leaf doesn't know it.
 
 // START copy from algorithmtutorprograms
 void TreeAllocator::rbt_transplant(tree_block_t* a, tree_block_t* b) {
@@ -11,7 +14,9 @@ void TreeAllocator::rbt_transplant(tree_block_t* a, tree_block_t* b) {
     } else {
         a->parent->right = b;
     }
-    b->parent = a->parent;
+    if (b != nullptr) {
+        b->parent = a->parent;
+    }
 }
 
 // insert the key to the tree in its appropriate position
@@ -63,10 +68,10 @@ void TreeAllocator::rbt_insert(tree_block_t* node) {
 // fix the red-black tree
 void TreeAllocator::rbt_fix_insert(tree_block_t* k) {
     tree_block_t* u;
-    while (k->parent->red) {
+    while (rbt_is_red(k->parent)) {
         if (k->parent == k->parent->parent->right) {
             u = k->parent->parent->left;  // uncle
-            if (u->red) {
+            if (rbt_is_red(u)) {
                 // case 3.1
                 u->red = false;
                 k->parent->red = false;
@@ -86,7 +91,7 @@ void TreeAllocator::rbt_fix_insert(tree_block_t* k) {
         } else {
             u = k->parent->parent->right;  // uncle
 
-            if (u->red) {
+            if (rbt_is_red(u)) {
                 // mirror case 3.1
                 u->red = false;
                 k->parent->red = false;
@@ -159,23 +164,27 @@ tree_block_t* TreeAllocator::rbt_minimum(tree_block_t* node) {
 
 void TreeAllocator::rbt_remove(tree_block_t* z) {
     tree_block_t* x;
+    tree_block_t* x_parent;
     tree_block_t* y;
 
     y = z;
     bool y_original_red = y->red;
     if (z->left == nullptr) {
         x = z->right;
+        x_parent = z->parent;
         rbt_transplant(z, z->right);
     } else if (z->right == nullptr) {
         x = z->left;
+        x_parent = z->parent;
         rbt_transplant(z, z->left);
     } else {
         y = rbt_minimum(z->right);
         y_original_red = y->red;
         x = y->right;
         if (y->parent == z) {
-            x->parent = y;
+            x_parent = y;
         } else {
+            x_parent = y->parent;
             rbt_transplant(y, y->right);
             y->right = z->right;
             y->right->parent = y;
@@ -187,105 +196,107 @@ void TreeAllocator::rbt_remove(tree_block_t* z) {
         y->red = z->red;
     }
     if (!y_original_red) {
-        rbt_fix_remove(x);
+        rbt_fix_remove(x, x_parent);
     }
 }
 
 // fix the rb tree modified by the delete operation
-void TreeAllocator::rbt_fix_remove(tree_block_t* x) {
+void TreeAllocator::rbt_fix_remove(tree_block_t* x, tree_block_t* parent) {
     tree_block_t* s;
-    while (x != free_start && !x->red) {
-        if (x == x->parent->left) {
-            s = x->parent->right;
+    while (x != free_start && !rbt_is_red(x)) {
+        // x carries an extra black, so the sibling can't be a leaf
+        if (x == parent->left) {
+            s = parent->right;
             if (s->red) {
                 // case 3.1
                 s->red = false;
-                x->parent->red = true;
-                rbt_rot_l(x->parent);
-                s = x->parent->right;
+                parent->red = true;
+                rbt_rot_l(parent);
+                s = parent->right;
             }
 
-            if (!s->left->red && !s->right->red) {
+            if (!rbt_is_red(s->left) && !rbt_is_red(s->right)) {
                 // case 3.2
                 s->red = true;
-                x = x->parent;
+                x = parent;
+                parent = x->parent;
             } else {
-                if (!s->right->red) {
+                if (!rbt_is_red(s->right)) {
                     // case 3.3
                     s->left->red = false;
                     s->red = true;
                     rbt_rot_r(s);
-                    s = x->parent->right;
+                    s = parent->right;
                 }
 
                 // case 3.4
-                s->red = x->parent->red;
-                x->parent->red = false;
+                s->red = parent->red;
+                parent->red = false;
                 s->right->red = false;
-                rbt_rot_l(x->parent);
+                rbt_rot_l(parent);
                 x = free_start;
+                parent = nullptr;
             }
         } else {
-            s = x->parent->left;
+            s = parent->left;
             if (s->red) {
                 // case 3.1
                 s->red = false;
-                x->parent->red = true;
-                rbt_rot_r(x->parent);
-                s = x->parent->left;
+                parent->red = true;
+                rbt_rot_r(parent);
+                s = parent->left;
             }
 
-            if (!s->right->red) {
+            if (!rbt_is_red(s->left) && !rbt_is_red(s->right)) {
                 // case 3.2
                 s->red = true;
-                x = x->parent;
+                x = parent;
+                parent = x->parent;
             } else {
-                if (!s->left->red) {
+                if (!rbt_is_red(s->left)) {
                     // case 3.3
                     s->right->red = false;
                     s->red = true;
                     rbt_rot_l(s);
-                    s = x->parent->left;
+                    s = parent->left;
                 }
 
                 // case 3.4
-                s->red = x->parent->red;
-                x->parent->red = false;
+                s->red = parent->red;
+                parent->red = false;
                 s->left->red = false;
-                rbt_rot_r(x->parent);
+                rbt_rot_r(parent);
                 x = free_start;
+                parent = nullptr;
             }
         }
     }
-    x->red = false;
+    if (x != nullptr) {
+        x->red = false;
+    }
 }
 // END copy from algorithmtutorprograms
 
-// This is recursive and depends on luck
-tree_block_t* TreeAllocator::rbt_search_bestfit(tree_block_t* node, unsigned int req_size) {
-    if (node == nullptr) {
-        return nullptr;
-    }
+// Iterative, remembers the smallest fitting block on the way down
+tree_block_t* TreeAllocator::rbt_search_bestfit(unsigned int req_size) {
+    tree_block_t* best = nullptr;
+    tree_block_t* node = free_start;
 
-    if (req_size < get_size(node)) {
-        if (node->left != nullptr && get_size(node->left) >= req_size) {
-            return rbt_search_bestfit(node->left, req_size);
+    while (node != nullptr) {
+        unsigned int size = get_size(node);
+        if (size == req_size) {
+            return node;  // Perfect fit
         }
 
-        return node;
-    }
-
-    if (req_size > get_size(node)) {
-        if (node->right != nullptr && get_size(node->right) >= req_size) {
-            return rbt_search_bestfit(node->right, req_size);
+        if (size > req_size) {
+            best = node;  // Fits, but there could be a smaller one on the left
+            node = node->left;
+        } else {
+            node = node->right;
         }
-
-        // Block doesn't fit
-        return nullptr;
     }
 
-    // Perfect fit
-    return node;
+    return best;
 }
 
 // DLL code
@@ -69,6 +69,9 @@ void bs_clear() {
     unsigned int y;
     unsigned short* ptr = reinterpret_cast<unsigned short*>(0xb8000);
 
+    // Der Bildschirm koennte hardwareseitig gescrollt sein
+    CGA::reset_scroll();
+
     for (x = 0; x < 80; x++) {
         for (y = 0; y < 25; y++) {
             *(ptr + y * 80 + x) = static_cast<short>(0x1F00);
@@ -301,5 +304,40 @@ void bs_dump(unsigned int exceptionNr) {
     // nur falls gdb benutzt werden soll
     break_on_bluescreen();
 
+    // Logausgaben die noch im LogRing oder im Sendepuffer liegen gehen sonst verloren
+    Logger::drain_serial();
+    SerialOut::flush();
+
+    bs_print_string("System halted\0");
+}
+
+/*****************************************************************************
+ * Funktion:        bs_double_fault                                          *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Bluescreen fuer Double Faults, die kein Stackueberlauf   *
+ *                  eines Threads sind. Laeuft im Double-Fault-Task, daher   *
+ *                  gibt es keinen Interrupt-Frame wie bei bs_dump.          *
+ *****************************************************************************/
+void bs_double_fault(unsigned int eip, unsigned int esp, unsigned int faultAddress) {
+    bs_clear();
+    bs_print_string("HHUos crashed with Exception \0");
+    bs_print_uintHex(8);
+    bs_print_string(" (Double Fault)\0");
+    bs_lf();
+    bs_lf();
+
+    bs_printReg("EIP=\0", eip);
+    bs_printReg("ESP=\0", esp);
+    bs_lf();
+
+    bs_print_string("Last page fault address = \0");
+    bs_print_uintHex(faultAddress);
+    bs_lf();
+    bs_lf();
+
+    break_on_bluescreen();
+    Logger::drain_serial();
+    SerialOut::flush();
+
     bs_print_string("System halted\0");
 }
@@ -16,4 +16,7 @@
 // dump blue screen (will not return)
 void bs_dump(unsigned int exceptionNr);
 
+// dump blue screen for a double fault, the registers come from the kernel TSS (will not return)
+void bs_double_fault(unsigned int eip, unsigned int esp, unsigned int faultAddress);
+
 #endif
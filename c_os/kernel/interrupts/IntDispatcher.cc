@@ -14,8 +14,10 @@
 #include "kernel/CPU.h"
 #include "kernel/Globals.h"
 #include "kernel/interrupts/Bluescreen.h"
+#include "kernel/interrupts/StackGuard.h"
 
 extern "C" void int_disp(unsigned int vector);
+extern "C" unsigned int get_page_fault_address();
 
 /*****************************************************************************
  * Prozedur:        int_disp                                                 *
@@ -34,15 +36,28 @@ void int_disp(unsigned int vector) {
     /* hier muss Code eingefuegt werden */
 
     if (vector < 32) {
+        if (vector == 14) {
+            sg_page_fault(get_page_fault_address());  // Doesn't return if a thread overflowed its stack
+        }
         bs_dump(vector);
         CPU::halt();
     }
 
+    Trace::event(Trace::IRQ_ENTER, vector);
+
+    // Any interrupt ends the tickless phase of the idle thread
+    if (vector != IntDispatcher::timer) {
+        pit.wakeup();
+    }
+
     if (intdis.report(vector) < 0) {
         kout << "Panic: unexpected interrupt " << vector;
         kout << " - processor halted." << endl;
         CPU::halt();
     }
+
+    // NOTE: If the interrupt caused a thread switch this is only reached once the thread runs again
+    Trace::event(Trace::IRQ_EXIT, vector);
 }
 
 /*****************************************************************************
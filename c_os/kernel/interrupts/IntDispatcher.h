@@ -19,7 +19,8 @@
 
 class IntDispatcher {
 private:
-    NamedLogger log;
+    // Called for every interrupt, debug messages are only compiled in when needed
+    BasicNamedLogger<Logger::ERROR> log;
 
     enum { size = 256 };
     bse::array<ISR*, size> map;
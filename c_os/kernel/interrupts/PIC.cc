@@ -20,6 +20,8 @@
 
 IOport const PIC::IMR1(0x21);  // interrupt mask register von PIC 1
 IOport const PIC::IMR2(0xa1);  // interrupt mask register von PIC 2
+IOport const PIC::CMD1(0x20);  // command register von PIC 1
+IOport const PIC::CMD2(0xa0);  // command register von PIC 2
 
 /*****************************************************************************
  * Methode:         PIC::allow                                               *
@@ -104,3 +106,28 @@ bool PIC::status(int irq) {
     unsigned char mask = 0x1 << (irq % 8);
     return IMR & mask;
 }
+
+/*****************************************************************************
+ * Methode:         PIC::end_pending                                         *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Sendet ein EOI fuer jeden IRQ, der im In-Service-Register*
+ *                  steht. Wird benoetigt, wenn eine Unterbrechungsbehand-   *
+ *                  lung nicht zurueckkehrt (Stackueberlauf), sonst bleiben  *
+ *                  der IRQ und alle niedriger priorisierten gesperrt.       *
+ *****************************************************************************/
+void PIC::end_pending() {
+
+    // NOTE: The PICs are programmed with automatic EOI (startup.asm), then the in-service registers
+    //       are always empty and nothing is sent
+
+    // OCW3: The next read from the command register returns the in-service register
+    CMD2.outb(0x0b);
+    for (unsigned int i = 0; i < 8 && CMD2.inb() != 0; ++i) {
+        CMD2.outb(0x20);  // Non-specific EOI, clears the highest priority IRQ in service
+    }
+
+    CMD1.outb(0x0b);
+    for (unsigned int i = 0; i < 8 && CMD1.inb() != 0; ++i) {
+        CMD1.outb(0x20);  // Also clears the cascade (IRQ 2) for the slave
+    }
+}
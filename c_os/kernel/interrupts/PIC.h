@@ -23,6 +23,8 @@ class PIC {
 private:
     static const IOport IMR1;  // interrupt mask register von PIC 1
     static const IOport IMR2;  // interrupt mask register von PIC 2
+    static const IOport CMD1;  // command register von PIC 1
+    static const IOport CMD2;  // command register von PIC 2
 
 public:
     PIC(const PIC& copy) = delete;  // Verhindere Kopieren
@@ -46,6 +48,9 @@ public:
 
     // Abfragen, ob die Weiterleitung fuer einen bestimmten IRQ unterdrueckt ist
     static bool status(int interrupt_device);
+
+    // Beendet alle IRQs, die der PIC noch als in Bearbeitung fuehrt (nach einem abgebrochenen Handler)
+    static void end_pending();
 };
 
 #endif
@@ -0,0 +1,170 @@
+/*****************************************************************************
+ *                                                                           *
+ *                          S T A C K G U A R D                              *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Erkennung von Stackueberlaeufen ueber die Guard-Pages    *
+ *                  der Thread-Stacks.                                       *
+ *                                                                           *
+ *                  GDT (siehe startup.asm):                                 *
+ *                      0x20: TSS des Kernels. Wird nur benoetigt, damit die *
+ *                            CPU beim Task-Wechsel den unterbrochenen       *
+ *                            Zustand sichern kann.                          *
+ *                      0x28: TSS des Double-Fault-Tasks                     *
+ *                  IDT-Eintrag 8 ist ein Task-Gate auf 0x28.                *
+ *****************************************************************************/
+#include "kernel/interrupts/StackGuard.h"
+#include "kernel/CPU.h"
+#include "kernel/Globals.h"
+#include "kernel/interrupts/Bluescreen.h"
+
+// in startup.asm
+extern "C" {
+    unsigned int get_page_fault_address();
+
+    extern unsigned int gdt[];
+    extern unsigned int idt[];
+
+    // Wird im Double-Fault-Task aufgerufen
+    void double_fault();
+}
+
+constexpr const unsigned int KERNEL_TSS = 0x20;
+constexpr const unsigned int DOUBLE_FAULT_TSS = 0x28;
+
+constexpr const unsigned int KERNEL_CS = 0x08;
+constexpr const unsigned int KERNEL_DS = 0x10;
+
+// 32-Bit Task State Segment
+struct tss_t {
+    unsigned short link, link_h;
+    unsigned int esp0;
+    unsigned short ss0, ss0_h;
+    unsigned int esp1;
+    unsigned short ss1, ss1_h;
+    unsigned int esp2;
+    unsigned short ss2, ss2_h;
+    unsigned int cr3, eip, eflags;
+    unsigned int eax, ecx, edx, ebx, esp, ebp, esi, edi;
+    unsigned short es, es_h;
+    unsigned short cs, cs_h;
+    unsigned short ss, ss_h;
+    unsigned short ds, ds_h;
+    unsigned short fs, fs_h;
+    unsigned short gs, gs_h;
+    unsigned short ldt, ldt_h;
+    unsigned short trap, iomap;
+} __attribute__((packed));
+
+tss_t kernel_tss;
+tss_t double_fault_tss;
+
+// Eigener Stack, der Stack des unterbrochenen Threads ist evtl. voll
+unsigned int double_fault_stack[1024] __attribute__((aligned(4096)));
+
+// TSS-Deskriptor (32-Bit TSS, nicht busy) in die GDT eintragen
+void sg_set_descriptor(unsigned int selector, const tss_t& tss) {
+    unsigned int base = reinterpret_cast<unsigned int>(&tss);
+    unsigned int limit = sizeof(tss_t) - 1;
+
+    gdt[selector / 4] = (base << 16) | limit;
+    gdt[selector / 4 + 1] = (base & 0xFF000000) | 0x8900 | ((base >> 16) & 0xFF);
+}
+
+/*****************************************************************************
+ * Funktion:        sg_init                                                  *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    TSS-Deskriptoren anlegen, TR laden und den Double Fault  *
+ *                  auf den eigenen Task umleiten.                           *
+ *****************************************************************************/
+void sg_init() {
+    unsigned int cr3;
+    asm volatile("mov %%cr3, %0" : "=r"(cr3));
+
+    // Der Kernel-TSS wird beim Wechsel in den Double-Fault-Task beschrieben,
+    // nur CR3 muss fuer den Rueckweg stimmen (wird nicht gesichert)
+    kernel_tss = tss_t {};
+    kernel_tss.cr3 = cr3;
+    kernel_tss.iomap = sizeof(tss_t);
+
+    double_fault_tss = tss_t {};
+    double_fault_tss.cr3 = cr3;
+    double_fault_tss.eip = reinterpret_cast<unsigned int>(&double_fault_entry);
+    double_fault_tss.eflags = 0x2;  // Interrupts gesperrt
+    double_fault_tss.esp = reinterpret_cast<unsigned int>(&double_fault_stack[1024]);
+    double_fault_tss.cs = KERNEL_CS;
+    double_fault_tss.ss = KERNEL_DS;
+    double_fault_tss.ds = KERNEL_DS;
+    double_fault_tss.es = KERNEL_DS;
+    double_fault_tss.fs = KERNEL_DS;
+    double_fault_tss.gs = KERNEL_DS;
+    double_fault_tss.iomap = sizeof(tss_t);
+
+    sg_set_descriptor(KERNEL_TSS, kernel_tss);
+    sg_set_descriptor(DOUBLE_FAULT_TSS, double_fault_tss);
+    tss_load(KERNEL_TSS);
+
+    // IDT-Eintrag 8: Task-Gate (present, DPL 0) auf den Double-Fault-TSS
+    idt[8 * 2] = DOUBLE_FAULT_TSS << 16;
+    idt[8 * 2 + 1] = 0x8500;
+}
+
+/*****************************************************************************
+ * Funktion:        sg_kill_thread                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Beendet einen Thread nach einem Stackueberlauf. Laeuft   *
+ *                  noch auf dem Stack des Threads, der dabei freigegeben    *
+ *                  wird (wie bei Scheduler::exit).                          *
+ *****************************************************************************/
+[[noreturn]] void sg_kill_thread() {
+    unsigned int tid = scheduler.get_active();
+
+    // The overflow might have happened while an IRQ was delivered or handled, that handler never returns
+    PIC::end_pending();
+
+    // The thread might have overflowed while assembling a log message, waiting for the lock would hang
+    Logger::abandon(tid);
+    Logger::instance().error("StackGuard::Stack overflow, killing the active thread");  // Doesn't take the lock
+
+    scheduler.kill(tid);  // Switches to the next thread
+
+    // Not reached, the active thread can't be the idle thread here
+    CPU::halt();
+    while (true) {}
+}
+
+void sg_page_fault(unsigned int fault_address) {
+    if (scheduler.stack_overflowed(fault_address) == nullptr) {
+        return;  // Regular page fault, show the bluescreen
+    }
+    sg_kill_thread();
+}
+
+/*****************************************************************************
+ * Funktion:        double_fault                                             *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Laeuft im Double-Fault-Task. Der Zustand des Kernels     *
+ *                  liegt im Kernel-TSS und wird beim iret wiederhergestellt.*
+ *                  Bei einem Stackueberlauf wird der Kernel-TSS so          *
+ *                  veraendert, dass es am oberen Ende des Stacks in         *
+ *                  sg_kill_thread weitergeht.                               *
+ *****************************************************************************/
+void double_fault() {
+    unsigned int fault_address = get_page_fault_address();
+    Thread* thread = scheduler.stack_overflowed(fault_address);
+
+    if (thread == nullptr) {
+        bs_double_fault(kernel_tss.eip, kernel_tss.esp, fault_address);
+        CPU::halt();
+        while (true) {}
+    }
+
+    // The stack content is lost anyway, continue at its top as if sg_kill_thread() was called
+    unsigned int* esp = thread->stack_top() - 1;
+    esp[0] = 0;  // Return address, sg_kill_thread doesn't return
+
+    kernel_tss.eip = reinterpret_cast<unsigned int>(&sg_kill_thread);
+    kernel_tss.esp = reinterpret_cast<unsigned int>(esp);
+    kernel_tss.ebp = 0;
+    kernel_tss.eflags = 0x2;  // Interrupts stay disabled until the next thread is started
+}
@@ -0,0 +1,31 @@
+/*****************************************************************************
+ *                                                                           *
+ *                          S T A C K G U A R D                              *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Unter jedem Thread-Stack liegt eine nicht vorhandene     *
+ *                  Guard-Page (siehe StackPool). Laeuft ein Stack ueber,    *
+ *                  gibt es einen Page Fault bzw. einen Double Fault, wenn   *
+ *                  die CPU den Interrupt-Frame nicht mehr auf den Stack     *
+ *                  legen kann. Der Double Fault wird daher ueber ein        *
+ *                  Task-Gate mit eigenem TSS und eigenem Stack behandelt.   *
+ *                  In beiden Faellen wird nur der betroffene Thread beendet.*
+ *****************************************************************************/
+
+#ifndef StackGuard_include__
+#define StackGuard_include__
+
+// Externe Funktionen in startup.asm
+extern "C" {
+    void tss_load(unsigned int selector);  // GDT neu laden und TR setzen
+    void double_fault_entry();             // Einsprung des Double-Fault-Tasks
+}
+
+// TSS und Task-Gate fuer Double Faults einrichten, nach pg_init aufrufen
+void sg_init();
+
+// Prueft bei einem Page Fault, ob der aktive Thread seinen Stack ueberlaufen hat.
+// Falls ja, wird der Thread beendet und die Funktion kehrt nicht zurueck.
+void sg_page_fault(unsigned int fault_address);
+
+#endif
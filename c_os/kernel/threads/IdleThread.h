@@ -30,6 +30,17 @@ public:
 
         while (true) {
             // kout << "Idle!" << endl;
+
+            // Tickless: If no other thread wants to run there is no reason for a timer interrupt,
+            // sleep until the next thread wakes up or any other interrupt comes
+            CPU::disable_int();
+            if (scheduler.nothing_ready()) {
+                pit.tickless(scheduler.ticks_until_wakeup(pit.max_tickless()));
+                CPU::idle();  // sti; hlt
+            } else {
+                CPU::enable_int();
+            }
+
             scheduler.yield();
         }
     }
@@ -0,0 +1,40 @@
+/*****************************************************************************
+ *                                                                           *
+ *                        L O G D R A I N T H R E A D                        *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Schreibt die gesammelten Log-Nachrichten im Hintergrund  *
+ *                  auf die serielle Schnittstelle bzw. den Bildschirm und   *
+ *                  sendet die aufgezeichneten Trace-Ereignisse ueber COM2.  *
+ *****************************************************************************/
+
+#ifndef LogDrainThread_include__
+#define LogDrainThread_include__
+
+#include "kernel/Globals.h"
+#include "kernel/threads/Thread.h"
+
+// Ticks between two drains, logging only gets delayed, nothing is lost unless the ring overflows
+constexpr const unsigned int LOG_DRAIN_INTERVAL = 5;
+
+class LogDrainThread : public Thread {
+public:
+    LogDrainThread(const LogDrainThread& copy) = delete;  // Verhindere Kopieren
+
+    // Writing to the CGA is slow, this shouldn't preempt other threads every LOG_DRAIN_INTERVAL ticks
+    LogDrainThread() : Thread("LogDrainThread") { background = true; }
+
+    [[noreturn]] void run() override {
+        Logger::enable_deferred();
+
+        while (true) {
+            Logger::drain();
+            Trace::drain();
+
+            // Sleeping instead of yielding so the idle thread can stop the timer in between
+            scheduler.sleep_for(LOG_DRAIN_INTERVAL);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*****************************************************************************
+ *                                                                           *
+ *                          R E A P E R T H R E A D                          *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Zerstoert beendete Threads, auf die niemand mit join     *
+ *                  wartet. Der Destruktor (Log-Ausgabe, Stack freigeben)    *
+ *                  laeuft so mit erlaubten Interrupts und nicht mehr auf    *
+ *                  dem Stack des beendeten Threads.                         *
+ *****************************************************************************/
+
+#ifndef ReaperThread_include__
+#define ReaperThread_include__
+
+#include "kernel/Globals.h"
+#include "kernel/threads/Thread.h"
+
+class ReaperThread : public Thread {
+public:
+    ReaperThread(const ReaperThread& copy) = delete;  // Verhindere Kopieren
+
+    ReaperThread() : Thread("ReaperThread") {}
+
+    [[noreturn]] void run() override {
+        while (true) {
+            bse::unique_ptr<Thread> zombie = scheduler.reap();  // Blocks until a thread exits
+            zombie.reset();
+        }
+    }
+};
+
+#endif
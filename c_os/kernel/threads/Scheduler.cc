@@ -6,6 +6,10 @@
  * Beschreibung:    Implementierung eines einfachen Zeitscheiben-Schedulers. *
  *                  Rechenbereite Threads werden in 'readQueue' verwaltet.   *
  *                                                                           *
+ *                  Die readyQueue besteht aus SCHED_LEVELS Prioritaets-     *
+ *                  stufen (Multi-Level-Feedback-Queue), alle Operationen    *
+ *                  auf den Warteschlangen sind O(1).                        *
+ *                                                                           *
  *                  Der Scheduler wird mit 'schedule' gestartet. Neue Threads*
  *                  können mit 'ready' hinzugefügt werden. Ein Thread muss   *
  *                  die CPU::freiwillig mit 'yield' abgeben, damit andere auch*
@@ -22,10 +26,79 @@
  *****************************************************************************/
 
 #include "kernel/threads/Scheduler.h"
+#include "kernel/Globals.h"
 #include "kernel/threads/IdleThread.h"
 #include <utility>
 
-constexpr const bool INSANE_TRACE = false;
+void Scheduler::enqueue(Thread& thread) {
+    thread.set_state(Thread::READY, CPU::rdtsc());
+    if (&thread == idle) {
+        return;  // Picked by pick_next() when the queues are empty
+    }
+    ready_levels[thread.priority].push_back(thread);
+    ready_bitmap |= 1U << thread.priority;
+}
+
+int Scheduler::top_level() {
+    while (ready_bitmap != 0) {
+        unsigned int level = __builtin_ctz(ready_bitmap);  // Lowest set bit is the highest priority
+        if (!ready_levels[level].empty()) {
+            return static_cast<int>(level);
+        }
+        ready_bitmap &= ~(1U << level);  // Stale bit, the level was emptied by remove()
+    }
+    return -1;
+}
+
+void Scheduler::promote(Thread& thread) {
+    // Blocking before the slice is used up is typical for interactive threads
+    if (thread.priority > 0 && !thread.background) {
+        --thread.priority;
+    }
+    thread.slice_used = 0;
+}
+
+Thread* Scheduler::pick_next() {
+    int level = top_level();
+    if (level < 0) {
+        // The idle thread is never queued, it only runs if nothing else is ready
+        return active == idle ? nullptr : idle;
+    }
+
+    Thread* next = ready_levels[level].pop_front();
+    next->priority = level;  // Threads moved by boost() don't know their new level yet
+    return next;
+}
+
+void Scheduler::boost() {
+    constexpr const unsigned int lowest = SCHED_LEVELS - 1;
+
+    for (unsigned int level = 1; level < lowest; ++level) {
+        ready_levels[0].splice_back(ready_levels[level]);
+    }
+
+    // Background threads stay on the lowest level
+    bse::intrusive_list<Thread> sorting;
+    sorting.splice_back(ready_levels[lowest]);
+    while (Thread* thread = sorting.pop_front()) {
+        ready_levels[thread->background ? lowest : 0].push_back(*thread);
+    }
+
+    ready_bitmap = 0;
+    if (!ready_levels[0].empty()) {
+        ready_bitmap |= 1U;
+    }
+    if (!ready_levels[lowest].empty()) {
+        ready_bitmap |= 1U << lowest;
+    }
+
+    if (active != idle && !active->background) {
+        active->priority = 0;
+        active->slice_used = 0;
+    }
+
+    log.trace() << "Boosted all ready threads to level 0" << endl;
+}
 
 /*****************************************************************************
  * Methode:         Dispatcher::dispatch                                     *
@@ -35,28 +108,74 @@ constexpr const bool INSANE_TRACE = false;
  * Parameter:                                                                *
  *      next        Thread der die CPU::erhalten soll.                        *
  *****************************************************************************/
-void Scheduler::start(bse::vector<bse::unique_ptr<Thread>>::iterator next) {
-    active = next;
-    if (active >= ready_queue.end()) {
-        active = ready_queue.begin();
-        log.debug() << "Scheduler::start started different thread than passed" << endl;
-    }
-    if constexpr (INSANE_TRACE) {
-        log.trace() << "Starting Thread with id: " << dec << (*active)->tid << endl;
-    }
-    (*active)->start();  // First dereference the Iterator, then the unique_ptr to get Thread
+void Scheduler::start(Thread& next) {
+    active = &next;
+    active->set_state(Thread::RUNNING, CPU::rdtsc());
+    Trace::event(Trace::SWITCH, 0, active->tid);
+    log.trace() << "Starting Thread with id: " << dec << active->tid << endl;
+    active->start();
 }
 
-void Scheduler::switch_to(Thread* prev_raw, bse::vector<bse::unique_ptr<Thread>>::iterator next) {
-    active = next;
-    if (active >= ready_queue.end()) {
-        active = ready_queue.begin();
-        // log.debug() << "Scheduler::switch_to started different thread than passed" << endl;
+void Scheduler::switch_to(Thread& prev, Thread& next, bool preempted) {
+    active = &next;
+    active->set_state(Thread::RUNNING, CPU::rdtsc());
+    if (&prev == &next) {
+        // The previous thread was the only one on the highest level, Thread_switch would enable interrupts
+        CPU::enable_int();
+        return;
     }
-    if constexpr (INSANE_TRACE) {
-        log.trace() << "Switching to Thread with id: " << dec << (*active)->tid << endl;
+    if (preempted) {
+        ++prev.stats.involuntary;
+    } else {
+        ++prev.stats.voluntary;
     }
-    prev_raw->switchTo(**active);
+    Trace::event(Trace::SWITCH, prev.tid, next.tid);
+    log.trace() << "Switching to Thread with id: " << dec << active->tid << endl;
+    prev.switchTo(next);
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::snapshot                                      *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Laufzeitstatistik aller Threads kopieren. Die Zeit im    *
+ *                  aktuellen Zustand wird bis jetzt mitgezaehlt.            *
+ *****************************************************************************/
+unsigned int Scheduler::snapshot(ThreadInfo* out, unsigned int max) {
+    unsigned int count = 0;
+
+    CPU::disable_int();
+    unsigned long long now = CPU::rdtsc();
+    threads.for_each([&](Thread& thread) {
+        if (count >= max) {
+            return;
+        }
+
+        ThreadInfo& info = out[count++];
+        info.tid = thread.tid;
+        info.state = thread.state;
+        info.priority = thread.priority;
+        info.stats = thread.stats;
+        info.stack_used = thread.stack_used();
+        info.stack_size = thread.stack_size();
+
+        unsigned int i = 0;
+        for (; i < sizeof(info.name) - 1 && thread.name[i] != '\0'; ++i) {
+            info.name[i] = thread.name[i];
+        }
+        info.name[i] = '\0';
+
+        unsigned long long elapsed = now - thread.state_since;
+        if (thread.state == Thread::RUNNING) {
+            info.stats.running += elapsed;
+        } else if (thread.state == Thread::READY) {
+            info.stats.ready += elapsed;
+        } else if (thread.state != Thread::EXITED) {
+            info.stats.blocked += elapsed;
+        }
+    });
+    CPU::enable_int();
+
+    return count;
 }
 
 /*****************************************************************************
@@ -73,9 +192,14 @@ void Scheduler::schedule() {
     // Otherwise preemption will be blocked and nothing will happen if the first threads
     // run() function is blocking
 
-    ready_queue.push_back(bse::make_unique<IdleThread>());
-    log.info() << "Starting scheduling: starting thread with id: " << dec << (*(ready_queue.end() - 1))->tid << endl;
-    start(ready_queue.end() - 1);
+    idle = bse::make_unique<IdleThread>().release();  // Owned by the scheduler, never exits
+    if (!idle->init_stack(STACK_DEFAULT_PAGES)) {
+        return;
+    }
+    idle->priority = SCHED_LEVELS - 1;
+    threads.insert(*idle);
+    log.info() << "Starting scheduling: starting thread with id: " << dec << idle->tid << endl;
+    start(*idle);
 }
 
 /*****************************************************************************
@@ -83,10 +207,23 @@ void Scheduler::schedule() {
  *---------------------------------------------------------------------------*
  * Beschreibung:    Thread in readyQueue eintragen.                          *
  *****************************************************************************/
-void Scheduler::ready(bse::unique_ptr<Thread>&& thread) {
+void Scheduler::ready(bse::unique_ptr<Thread>&& thread, unsigned int stack_pages) {
+    if (!thread->init_stack(stack_pages)) {
+        return;  // Unsupported size or no pages left, the thread is deleted with the unique_ptr
+    }
+
+    if (thread->background) {
+        thread->priority = SCHED_LEVELS - 1;
+    }
+
     CPU::disable_int();
+    if (!threads.insert(*thread)) {
+        log.error() << "Can't add thread with id: " << dec << thread->tid << ", thread table is full" << endl;
+        CPU::enable_int();
+        return;  // The thread is deleted with the unique_ptr
+    }
     log.debug() << "Adding to ready_queue, ID: " << dec << thread->tid << endl;
-    ready_queue.push_back(std::move(thread));
+    enqueue(*thread.release());  // The scheduler owns the thread until it exits or is killed
     CPU::enable_int();
 }
 
@@ -105,16 +242,16 @@ void Scheduler::exit() {
     // Thread-Wechsel durch PIT verhindern
     CPU::disable_int();
 
-    if (ready_queue.size() == 1) {
-        log.error() << "Can't exit last thread, active ID: " << dec << (*active)->tid << endl;
+    Thread* next = pick_next();
+    if (next == nullptr) {
+        log.error() << "Can't exit last thread, active ID: " << dec << active->tid << endl;
         CPU::enable_int();
         return;
     }
 
-    log.debug() << "Exiting thread, ID: " << dec << (*active)->tid << endl;
-    start(ready_queue.erase(active));  // erase returns the next iterator after the erased element
-                                       // cannot use switch_to here as the previous thread no longer
-                                       // exists (was deleted by erase)
+    log.debug() << "Exiting thread, ID: " << dec << active->tid << endl;
+    make_zombie(*active);  // We are still on its stack, so it can only be destroyed after the switch
+    start(*next);          // The exited thread isn't saved anymore, so switch_to isn't needed
 
     // Interrupts werden in Thread_switch in Thread.asm wieder zugelassen
     // dispatch kehr nicht zurueck
@@ -134,93 +271,89 @@ void Scheduler::exit() {
 void Scheduler::kill(unsigned int tid, bse::unique_ptr<Thread>* ptr) {
     CPU::disable_int();
 
-    unsigned int prev_tid = (*active)->tid;
-
-    // Block queue, can always kill
-    for (bse::vector<bse::unique_ptr<Thread>>::iterator it = block_queue.begin(); it != block_queue.end(); ++it) {
-        if ((*it)->tid == tid) {
-            // Found thread to kill
-
-            if (ptr != nullptr) {
-                // Move old thread out of queue to return it
-                unsigned int pos = bse::distance(block_queue.begin(), it);
-                *ptr = std::move(block_queue[pos]);  // Return the killed thread
-            }
-
-            // Just erase from queue, do not need to switch
-            block_queue.erase(it);
-            log.info() << "Killed thread from block_queue with id: " << tid << endl;
-
-            CPU::enable_int();
-            return;
-        }
+    Thread* thread = find(tid);
+    if (thread == nullptr) {
+        log.error() << "Kill: Couldn't find thread with id: " << tid << endl;
+        log.error() << "Mabe it already exited itself?" << endl;
+        CPU::enable_int();
+        return;
     }
-
-    // Ready queue, can't kill last one
-    if (ready_queue.size() == 1) {
-        log.error() << "Kill: Can't kill last thread in ready_queue with id: " << tid << endl;
+    if (thread == idle) {
+        log.error() << "Kill: Can't kill idle thread with id: " << tid << endl;
+        CPU::enable_int();
+        return;
+    }
+    if (reaper_tid != 0 && tid == reaper_tid) {
+        log.error() << "Kill: Can't kill reaper thread with id: " << tid << endl;
+        CPU::enable_int();
+        return;
+    }
+    if (thread->state == Thread::EXITED) {
+        log.debug() << "Kill: Thread with id: " << tid << " already exited" << endl;
         CPU::enable_int();
         return;
     }
 
-    for (bse::vector<bse::unique_ptr<Thread>>::iterator it = ready_queue.begin(); it != ready_queue.end(); ++it) {
-        if ((*it)->tid == tid) {
-            // Found thread to kill
-
-            if (ptr != nullptr) {
-                // Move old thread out of queue to return it
-                unsigned int pos = bse::distance(ready_queue.begin(), it);
-                *ptr = std::move(ready_queue[pos]);  // Return the killed thread
-            }
-
-            if (tid == prev_tid) {
-                // If we killed the active thread we need to switch to another one
-                log.info() << "Killed active thread from ready_queue with id: " << tid << endl;
-
-                // Switch to current active after old active was removed
-                start(ready_queue.erase(it));
-            }
-
-            // Just erase from queue, do not need to switch
-            ready_queue.erase(it);
-            log.info() << "Killed thread from ready_queue with id: " << tid << endl;
+    if (thread == active) {
+        // If we killed the active thread we need to switch to another one,
+        // this always succeeds as the idle thread is ready
+        Thread* next = pick_next();
+        log.info() << "Killed active thread with id: " << tid << endl;
 
-            CPU::enable_int();
-            return;
+        if (ptr != nullptr) {
+            // The caller is the killed thread itself, it would be destroyed while still running on its stack
+            log.error() << "Kill: Can't return the active thread, it is reaped instead" << endl;
         }
+        make_zombie(*thread);
+        start(*next);
+    }
+
+    // Ready-, block- or sleep-queue, just unlink, do not need to switch
+    bse::intrusive_list<Thread>::remove(*thread);
+    log.info() << "Killed thread with id: " << tid << endl;
+
+    if (ptr != nullptr) {
+        threads.remove(tid);
+        thread->set_state(Thread::EXITED, CPU::rdtsc());
+        wake_joiner(*thread);  // Its join() returns nullptr as the tid is gone
+        ptr->reset(thread);  // Return the killed thread
+    } else {
+        make_zombie(*thread);
     }
 
-    log.error() << "Kill: Couldn't find thread with id: " << tid << " in ready- or block-queue" << endl;
-    log.error() << "Mabe it already exited itself?" << endl;
     CPU::enable_int();
 }
 
-// TODO: Can't retrive the thread right now because it's not clear when it's finished,
-//       maybe introduce a exited_queue and get it from there
+// NOTE: The thread can't be returned here as it's not clear when it's finished, use join() for that
 void Scheduler::nice_kill(unsigned int tid, bse::unique_ptr<Thread>* ptr) {
     CPU::disable_int();
 
-    for (bse::unique_ptr<Thread>& thread : block_queue) {
-        if (thread->tid == tid) {
-            thread->suicide();
-            log.info() << "Nice killed thread in block_queue with id: " << tid << endl;
-            deblock(tid);
-            CPU::enable_int();
-            return;
-        }
+    Thread* thread = find(tid);
+    if (thread == nullptr) {
+        log.error() << "Can't nice kill thread (not found) with id: " << tid << endl;
+        log.error() << "Mabe it already exited itself?" << endl;
+        CPU::enable_int();
+        return;
     }
-
-    for (bse::unique_ptr<Thread>& thread : ready_queue) {
-        if (thread->tid == tid) {
-            thread->suicide();
-            log.info() << "Nice killed thread in ready_queue with id: " << tid << endl;
-            CPU::enable_int();
-            return;
-        }
+    if (thread == idle || (reaper_tid != 0 && tid == reaper_tid)) {
+        log.error() << "Can't nice kill idle or reaper thread with id: " << tid << endl;
+        CPU::enable_int();
+        return;
     }
 
-    log.error() << "Can't nice kill thread (not found) with id: " << tid << endl;
-    log.error() << "Mabe it already exited itself?" << endl;
+    thread->suicide();
+    if (thread->state == Thread::EXITED) {
+        log.debug() << "Nice kill: Thread with id: " << tid << " already exited" << endl;
+    } else if (thread->state == Thread::BLOCKED) {
+        log.info() << "Nice killed thread in block_queue with id: " << tid << endl;
+        deblock(tid);  // Wake it up so it can see that it should exit
+    } else if (thread->state == Thread::SLEEPING) {
+        log.info() << "Nice killed sleeping thread with id: " << tid << endl;
+        bse::intrusive_list<Thread>::remove(*thread);
+        enqueue(*thread);
+    } else {
+        log.info() << "Nice killed thread in ready_queue with id: " << tid << endl;
+    }
     CPU::enable_int();
 }
 
@@ -242,17 +375,18 @@ void Scheduler::yield() {
     // Thread-Wechsel durch PIT verhindern
     CPU::disable_int();
 
-    if (ready_queue.size() == 1) {
-        if constexpr (INSANE_TRACE) {
-            log.trace() << "Skipping yield as no thread is waiting, active ID: " << dec << (*active)->tid << endl;
-        }
+    if (top_level() < 0) {
+        log.trace() << "Skipping yield as no thread is waiting, active ID: " << dec << active->tid << endl;
         CPU::enable_int();
         return;
     }
-    if constexpr (INSANE_TRACE) {
-        log.trace() << "Yielding, ID: " << dec << (*active)->tid << endl;
-    }
-    switch_to((*active).get(), active + 1);  // prev_raw is valid since no thread was killed/deleted
+    log.trace() << "Yielding, ID: " << dec << active->tid << endl;
+
+    // Yielding keeps the level, the thread gets the CPU again if no other thread on the same or
+    // a higher level is ready
+    Thread* prev = active;
+    enqueue(*prev);
+    switch_to(*prev, *pick_next());
 }
 
 /*****************************************************************************
@@ -267,7 +401,48 @@ void Scheduler::preempt() {
     /* Hier muss Code eingefuegt werden */
 
     CPU::disable_int();
-    yield();
+
+    if (++ticks_since_boost >= SCHED_BOOST_INTERVAL) {
+        ticks_since_boost = 0;
+        boost();
+    }
+
+    Thread* prev = active;
+    if (prev == idle) {
+        // The idle thread gives up the CPU as soon as any other thread is ready
+        if (top_level() < 0) {
+            CPU::enable_int();
+            return;
+        }
+        enqueue(*prev);
+        switch_to(*prev, *pick_next(), true);
+        return;
+    }
+
+    bool expired = ++prev->slice_used >= slice_ticks(prev->priority);
+    if (expired) {
+        prev->slice_used = 0;
+        if (prev->priority < SCHED_LEVELS - 1) {
+            ++prev->priority;  // Used the whole slice, probably CPU-bound
+        }
+    }
+
+    // Only switch if a thread with a higher priority is ready or the slice is used up
+    int top = top_level();
+    if (top < 0 || top > static_cast<int>(prev->priority) || (!expired && top == static_cast<int>(prev->priority))) {
+        CPU::enable_int();
+        return;
+    }
+
+    if (expired) {
+        enqueue(*prev);
+    } else {
+        // Preempted by a higher level, continue with the rest of the slice first
+        prev->set_state(Thread::READY, CPU::rdtsc());
+        ready_levels[prev->priority].push_front(*prev);
+        ready_bitmap |= 1U << prev->priority;
+    }
+    switch_to(*prev, *pick_next(), true);
 }
 
 /*****************************************************************************
@@ -275,32 +450,56 @@ void Scheduler::preempt() {
  *---------------------------------------------------------------------------*
  * Beschreibung:    Aufrufer ist blockiert. Es soll auf den naechsten Thread *
  *                  umgeschaltet werden. Der Aufrufer soll nicht in die      *
- *                  readyQueue eingefuegt werden und wird extern verwaltet.  *
- *                  Wird bei uns nur fuer Semaphore verwendet. Jede Semaphore*
- *                  hat eine Warteschlange wo der Thread dann verwaltet wird.*
+ *                  readyQueue eingefuegt werden, sondern in 'queue' (z.B.   *
+ *                  die Warteschlange einer Semaphore).                      *
  *                  Die Methode kehrt nicht zurueck, sondern schaltet um.    *
  *****************************************************************************/
-void Scheduler::block() {
+void Scheduler::block(WaitQueue& queue) {
 
     /* hier muss Code eingefuegt werden */
 
     CPU::disable_int();
 
-    if (ready_queue.size() == 1) {
-        log.error() << "Can't block last thread, active ID: " << dec << (*active)->tid << endl;
+    Thread* next = pick_next();
+    if (next == nullptr) {
+        log.error() << "Can't block last thread, active ID: " << dec << active->tid << endl;
         CPU::enable_int();
         return;
     }
 
-    Thread* prev_raw = (*active).get();
-    std::size_t pos = bse::distance(ready_queue.begin(), active);
-    block_queue.push_back(std::move(ready_queue[pos]));
+    Thread* prev = active;
+    promote(*prev);
+    prev->set_state(Thread::BLOCKED, CPU::rdtsc());
+    queue.threads.push_back(*prev);
+
+    log.trace() << "Blocked thread with id: " << prev->tid << endl;
+
+    switch_to(*prev, *next);
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::wake_one                                      *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Ersten Thread aus der Warteschlange 'queue' in die       *
+ *                  readyQueue eintragen.                                    *
+ *                                                                           *
+ * Rueckgabewert:   tid des Threads, 0 falls die Warteschlange leer war      *
+ *****************************************************************************/
+unsigned int Scheduler::wake_one(WaitQueue& queue) {
+    unsigned int flags = CPU::save_and_disable_int();
 
-    if constexpr (INSANE_TRACE) {
-        log.trace() << "Blocked thread with id: " << prev_raw->tid << endl;
+    Thread* thread = queue.threads.pop_front();
+    if (thread == nullptr) {
+        CPU::restore_int(flags);
+        return 0;
     }
 
-    switch_to(prev_raw, ready_queue.erase(active));  // prev_raw is valid as thread was moved before vector erase
+    enqueue(*thread);
+    log.trace() << "Woke thread with id: " << thread->tid << endl;
+    unsigned int tid = thread->tid;
+    CPU::restore_int(flags);
+
+    return tid;
 }
 
 /*****************************************************************************
@@ -320,22 +519,196 @@ void Scheduler::deblock(unsigned int tid) {
 
     CPU::disable_int();
 
-    for (bse::vector<bse::unique_ptr<Thread>>::iterator it = block_queue.begin(); it != block_queue.end(); ++it) {
-        if ((*it)->tid == tid) {
-            // Found thread with correct tid
+    Thread* thread = find(tid);
+    if (thread == nullptr || thread->state != Thread::BLOCKED) {
+        log.error() << "Couldn't deblock thread with id: " << tid << endl;
+        CPU::enable_int();
+        return;
+    }
+
+    wake(*thread);
+    log.trace() << "Deblocked thread with id: " << tid << endl;
+    CPU::enable_int();
+}
+
+void Scheduler::wake(Thread& thread) {
+    // The deblocked thread is preferred by its (promoted) level
+    bse::intrusive_list<Thread>::remove(thread);
+    enqueue(thread);
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::make_zombie                                   *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Beendeten Thread in die exited_queue eintragen und den   *
+ *                  Thread wecken, der ihn abholt (join oder Reaper). Der    *
+ *                  Thread darf in keiner anderen Warteschlange sein.        *
+ *****************************************************************************/
+void Scheduler::make_zombie(Thread& thread) {
+    thread.set_state(Thread::EXITED, CPU::rdtsc());
+    exited_queue.push_back(thread);
+
+    if (!wake_joiner(thread) && reaper_waiting) {
+        reaper_waiting = false;
+
+        Thread* reaper = find(reaper_tid);
+        if (reaper == nullptr) {
+            // Should not happen as the reaper can't be killed, the zombies just stay in the exited_queue
+            log.error() << "Reaper thread with id: " << reaper_tid << " is gone" << endl;
+            reaper_tid = 0;
+        } else {
+            wake(*reaper);
+        }
+    }
+}
+
+// The joiner could have been killed while waiting, then the reaper has to take care of the thread
+bool Scheduler::has_joiner(const Thread& thread) const {
+    return thread.joiner != 0 && alive(thread.joiner);
+}
+
+bool Scheduler::wake_joiner(const Thread& thread) {
+    if (!has_joiner(thread)) {
+        return false;
+    }
+
+    // The joiner is only blocked in join(), otherwise it will see the new state when it runs again
+    Thread* joiner = find(thread.joiner);
+    if (joiner->state == Thread::BLOCKED) {
+        wake(*joiner);
+    }
+    return true;
+}
 
-            std::size_t pos = bse::distance(block_queue.begin(), it);
-            ready_queue.insert(active + 1, std::move(block_queue[pos]));  // We insert the thread after the active
-                                                                          // thread to prefer deblocked threads
-            block_queue.erase(it);
-            if constexpr (INSANE_TRACE) {
-                log.trace() << "Deblocked thread with id: " << tid << endl;
+/*****************************************************************************
+ * Methode:         Scheduler::reap                                          *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Naechsten beendeten Thread, auf den niemand wartet, aus  *
+ *                  der exited_queue holen. Blockiert, falls es keinen gibt. *
+ *                  Der Thread wird vom Aufrufer mit erlaubten Interrupts    *
+ *                  zerstoert.                                               *
+ *****************************************************************************/
+bse::unique_ptr<Thread> Scheduler::reap() {
+    CPU::disable_int();
+    reaper_tid = active->tid;
+
+    while (true) {
+        for (Thread& thread : exited_queue) {
+            if (!has_joiner(thread)) {
+                bse::intrusive_list<Thread>::remove(thread);  // Stops the iteration
+                threads.remove(thread.tid);
+                CPU::enable_int();
+
+                bse::unique_ptr<Thread> zombie;
+                zombie.reset(&thread);
+                return zombie;
             }
+        }
+
+        reaper_waiting = true;
+        block();
+        CPU::disable_int();
+    }
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::join                                          *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Warten, bis der Thread 'tid' beendet ist, und ihn an den *
+ *                  Aufrufer uebergeben.                                     *
+ *                                                                           *
+ * Parameter:       tid:  Thread auf den gewartet wird.                      *
+ *****************************************************************************/
+bse::unique_ptr<Thread> Scheduler::join(unsigned int tid) {
+    CPU::disable_int();
+
+    Thread* thread = find(tid);
+    if (thread == nullptr || thread == active || thread == idle) {
+        log.error() << "Join: Can't join thread with id: " << tid << endl;
+        CPU::enable_int();
+        return bse::unique_ptr<Thread>();
+    }
+    if (has_joiner(*thread)) {
+        log.error() << "Join: Thread with id: " << tid << " is already joined by " << thread->joiner << endl;
+        CPU::enable_int();
+        return bse::unique_ptr<Thread>();
+    }
+
+    thread->joiner = active->tid;
+    while (thread->state != Thread::EXITED) {
+        block();  // Woken by make_zombie
+        CPU::disable_int();
+
+        // A kill that returned the thread to its caller removes it from the table
+        thread = find(tid);
+        if (thread == nullptr) {
             CPU::enable_int();
-            return;
+            return bse::unique_ptr<Thread>();
         }
     }
 
-    log.error() << "Couldn't deblock thread with id: " << tid << endl;
+    bse::intrusive_list<Thread>::remove(*thread);
+    threads.remove(tid);
     CPU::enable_int();
+
+    log.debug() << "Joined thread with id: " << tid << endl;
+    bse::unique_ptr<Thread> joined;
+    joined.reset(thread);
+    return joined;
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::sleep_until                                   *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Aufrufer schlaeft bis systime 'tick' erreicht. Er wird   *
+ *                  dazu in das Timer-Rad eingetragen und es wird auf den    *
+ *                  naechsten Thread umgeschaltet.                           *
+ *                                                                           *
+ * Parameter:       tick:  Zeitpunkt zum Aufwachen in PIT-Ticks.             *
+ *****************************************************************************/
+void Scheduler::sleep_until(unsigned long tick) {
+    CPU::disable_int();
+
+    if (tick <= systime) {
+        CPU::enable_int();
+        return;
+    }
+
+    Thread* next = pick_next();
+    if (next == nullptr) {
+        log.error() << "Can't put last thread to sleep, active ID: " << dec << active->tid << endl;
+        CPU::enable_int();
+        return;
+    }
+
+    Thread* prev = active;
+    promote(*prev);
+    prev->set_state(Thread::SLEEPING, CPU::rdtsc());
+    sleepers.insert(*prev, tick);
+
+    log.trace() << "Thread with id: " << prev->tid << " sleeps until " << tick << endl;
+
+    switch_to(*prev, *next);
+}
+
+void Scheduler::sleep_for(unsigned long ticks) {
+    sleep_until(systime + ticks);
+}
+
+/*****************************************************************************
+ * Methode:         Scheduler::wakeup_sleepers                               *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Dreht das Timer-Rad bis 'now' weiter und traegt alle     *
+ *                  abgelaufenen Threads in die readyQueue ein. Wird aus der *
+ *                  ISR des PITs gerufen, der Threadwechsel passiert danach  *
+ *                  in 'preempt'.                                            *
+ *****************************************************************************/
+void Scheduler::wakeup_sleepers(unsigned long now) {
+    bse::intrusive_list<Thread> expired;
+    sleepers.advance(now, expired);
+
+    while (Thread* thread = expired.pop_front()) {
+        log.trace() << "Woke up thread with id: " << thread->tid << endl;
+        enqueue(*thread);
+    }
 }
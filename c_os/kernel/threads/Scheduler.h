@@ -13,55 +13,130 @@
 #define Scheduler_include__
 
 #include "kernel/threads/Thread.h"
+#include "kernel/threads/ThreadTable.h"
+#include "kernel/threads/TimerWheel.h"
+#include "kernel/threads/WaitQueue.h"
+#include "user/lib/Array.h"
+#include "user/lib/IntrusiveList.h"
 #include "user/lib/mem/UniquePointer.h"
 #include "user/lib/utility/Logger.h"
-#include "user/lib/Vector.h"
+
+// Multi-level feedback queue: Threads start at level 0 (highest priority), are demoted when they use up
+// their whole time slice and promoted when they block before that. All levels are boosted back to level 0
+// periodically so CPU-bound threads can't starve.
+constexpr const unsigned int SCHED_LEVELS = 8;
+constexpr const unsigned int SCHED_BOOST_INTERVAL = 100;  // In PIT ticks (1s)
+
+// Copy of the accounting data of a thread, see Scheduler::snapshot
+struct ThreadInfo {
+    unsigned int tid;
+    char name[16];
+    Thread::State state;
+    unsigned int priority;
+    Thread::stats_t stats;  // Includes the time spent in the current state so far
+    unsigned int stack_used;
+    unsigned int stack_size;
+};
 
 class Scheduler {
 private:
-    NamedLogger log;
+    // Traces on every switch would flood the log, they are only compiled in when debugging the scheduler
+    BasicNamedLogger<Logger::DEBUG> log;
+
+    // One FIFO per level, bit n of ready_bitmap is set if ready_levels[n] might contain threads.
+    // Bits are set on insertion and only cleared lazily when an empty level is found during the search,
+    // so threads can be removed from anywhere in O(1) without knowing their level.
+    bse::array<bse::intrusive_list<Thread>, SCHED_LEVELS> ready_levels;
+    unsigned int ready_bitmap = 0;
+
+    WaitQueue block_queue;  // Threads blocked with block(), semaphores have their own queues
 
-    bse::vector<bse::unique_ptr<Thread>> ready_queue;
-    bse::vector<bse::unique_ptr<Thread>> block_queue;
+    // Exited and killed threads. They are destroyed by the ReaperThread or handed out by join(),
+    // so ~Thread (logging, freeing the stack) never runs with interrupts disabled.
+    bse::intrusive_list<Thread> exited_queue;
+    unsigned int reaper_tid = 0U;
+    bool reaper_waiting = false;  // The reaper is blocked in reap()
 
-    // NOTE: It makes sense to keep track of the active thread through this as it makes handling the
-    //       unique_ptr easier and reduces the copying in the vector when cycling through the threads
-    bse::vector<bse::unique_ptr<Thread>>::iterator active = nullptr;
+    // Sleeping threads, sorted by wakeup tick
+    TimerWheel sleepers;
+
+    // All threads known to the scheduler by tid, so no queue has to be searched
+    ThreadTable threads;
+
+    // The active thread is not contained in any queue while it is running
+    Thread* active = nullptr;
+    Thread* idle = nullptr;  // Not part of any queue, runs only if no other thread is ready
+
+    unsigned int ticks_since_boost = 0;
 
     // Scheduler wird evt. von einer Unterbrechung vom Zeitgeber gerufen,
     // bevor er initialisiert wurde
     unsigned int idle_tid = 0U;
 
+    static unsigned int slice_ticks(unsigned int level) { return level + 1; }
+
+    void enqueue(Thread& thread);  // Append to the queue of the threads level
+    int top_level();               // Highest non-empty level or -1, clears stale bitmap bits
+    Thread* pick_next();           // Removes the thread with the highest priority from its queue, else idle
+    void boost();                  // Moves all ready threads to level 0
+    void promote(Thread& thread);  // Called when a thread gives up the CPU before its slice is used up
+
+    Thread* find(unsigned int tid) const { return threads.find(tid); }  // nullptr if not found
+
+    void wake(Thread& thread);        // Moves a blocked thread to its ready queue, interrupts have to be disabled
+    void make_zombie(Thread& thread);  // Moves the (already unlinked) thread to the exited_queue
+    bool has_joiner(const Thread& thread) const;
+    bool wake_joiner(const Thread& thread);  // false if nobody joins the thread
+
+    // Only called by the ReaperThread, blocks until there is an exited thread nobody joins
+    bse::unique_ptr<Thread> reap();
+    friend class ReaperThread;
+
     // Roughly the old dispatcher functionality
-    void start(bse::vector<bse::unique_ptr<Thread>>::iterator next);                        // Start next without prev
-    void switch_to(Thread* prev_raw, bse::vector<bse::unique_ptr<Thread>>::iterator next);  // Switch from prev to next
+    void start(Thread& next);                                           // Start next without prev
+    void switch_to(Thread& prev, Thread& next, bool preempted = false);  // Switch from prev to next
 
     // Kann nur vom Idle-Thread aufgerufen werden (erster Thread der vom Scheduler gestartet wird)
     void enable_preemption(unsigned int tid) { idle_tid = tid; }
     friend class IdleThread;
 
-    void ready(bse::unique_ptr<Thread>&& thread);
+    void ready(bse::unique_ptr<Thread>&& thread, unsigned int stack_pages = STACK_DEFAULT_PAGES);
 
 public:
     Scheduler(const Scheduler& copy) = delete;  // Verhindere Kopieren
 
-    Scheduler() : log("SCHED"), ready_queue(true), block_queue(true) {}  // lazy queues, wait for allocator
+    // The queues don't allocate, so the scheduler can be used before the allocator is initialized
+    Scheduler() : log("SCHED") {}
 
-    // The scheduler has to init the queues explicitly after the allocator is available
-    void init() {
-        ready_queue.reserve();
-        block_queue.reserve();
+    unsigned int get_active() const {
+        return active->tid;
     }
 
-    unsigned int get_active() const {
-        return (*active)->tid;
+    // Is the thread with this tid still managed by the scheduler (not exited or killed)
+    // NOTE: The table is only modified by threads with interrupts disabled, so this
+    //       can also be used from interrupt handlers
+    bool alive(unsigned int tid) const {
+        Thread* thread = find(tid);
+        return thread != nullptr && thread->state != Thread::EXITED;
     }
 
+    // True if no thread except the active one is ready, has to be called with interrupts disabled
+    bool nothing_ready() { return top_level() < 0; }
+
     // Scheduler initialisiert?
     // Zeitgeber-Unterbrechung kommt evt. bevor der Scheduler fertig
     // intiialisiert wurde!
     bool preemption_enabled() const { return idle_tid != 0U; }
 
+    // The active thread if address lies in its stack guard page, otherwise nullptr (also for the idle thread,
+    // which can't be killed). Called from the page and double fault handlers.
+    Thread* stack_overflowed(unsigned int address) const {
+        return active != nullptr && active != idle && active->in_guard_page(address) ? active : nullptr;
+    }
+
+    // Copies the accounting data of up to max threads, returns the number of threads copied
+    unsigned int snapshot(ThreadInfo* out, unsigned int max);
+
     // Scheduler starten
     void schedule();
 
@@ -76,12 +151,27 @@ public:
         return tid;
     }
 
+    // Same with a larger stack, the size is rounded up to whole pages
+    template<typename T, typename... Args>
+    unsigned int ready(StackSize size, Args... args) {
+        bse::unique_ptr<Thread> thread = bse::make_unique<T>(std::forward<Args>(args)...);
+        unsigned int tid = thread->tid;
+
+        ready(std::move(thread), StackPool::pages_for(size.bytes));
+
+        return tid;
+    }
+
     // Thread terminiert sich selbst
-    // NOTE: When a thread exits itself it will disappear...
-    //       Maybe put exited threads in an exited queue?
-    //       Then they would have to be acquired from there to exit...
+    // NOTE: The thread becomes a zombie in the exited_queue, it is destroyed later by the
+    //       ReaperThread or returned by join()
     void exit();  // Returns on error because we don't have exceptions
 
+    // Blocks until the thread with this tid has exited (or was killed) and returns it,
+    // the caller destroys it. Returns nullptr if the tid is unknown (e.g. already reaped)
+    // or another thread already joins it.
+    bse::unique_ptr<Thread> join(unsigned int tid);
+
     // Thread mit 'Gewalt' terminieren
     void kill(unsigned int tid, bse::unique_ptr<Thread>* ptr);
     void kill(unsigned int tid) { kill(tid, nullptr); }
@@ -100,10 +190,27 @@ public:
     void preempt();  // Returns when only the idle thread runs
 
     // Blocks current thread (move to block_queue)
-    void block();  // Returns on error because we don't have exceptions
+    void block() { block(block_queue); }  // Returns on error because we don't have exceptions
+
+    // Blocks current thread in queue until it is woken by wake_one(queue) or deblock(tid)
+    void block(WaitQueue& queue);  // Returns on error because we don't have exceptions
+
+    // Deblocks the first thread of the queue, returns its tid or 0 if the queue was empty
+    // NOTE: Doesn't enable interrupts, so callers can release their locks first (Semaphore)
+    unsigned int wake_one(WaitQueue& queue);
 
     // Deblock by tid (move to ready_queue)
     void deblock(unsigned int tid);
+
+    // Puts the current thread to sleep until systime reaches 'tick'
+    void sleep_until(unsigned long tick);  // Returns on error because we don't have exceptions
+    void sleep_for(unsigned long ticks);
+
+    // Wakes all threads whose time has come, called from the PIT on every tick
+    void wakeup_sleepers(unsigned long now);
+
+    // Ticks until the next sleeping thread could wake up, at most 'max'
+    unsigned int ticks_until_wakeup(unsigned int max) const { return sleepers.ticks_until_next(max); }
 };
 
 #endif
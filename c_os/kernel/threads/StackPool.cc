@@ -0,0 +1,97 @@
+#include "kernel/threads/StackPool.h"
+#include "kernel/CPU.h"
+#include "kernel/Paging.h"
+#include "user/lib/mem/Memory.h"
+
+unsigned int StackPool::pages_for(unsigned int bytes) {
+    unsigned int pages = (bytes + STACK_PAGE_SIZE - 1) / STACK_PAGE_SIZE;
+    if (pages == 0 || pages > STACK_MAX_PAGES) {
+        return 0;
+    }
+    return pages;
+}
+
+/*****************************************************************************
+ * Methode:         StackPool::alloc                                         *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Stack aus der Freiliste nehmen oder neue Seiten holen.   *
+ *                  Wird auch mit gesperrten Interrupts aufgerufen.          *
+ *****************************************************************************/
+unsigned int* StackPool::alloc(unsigned int pages) {
+    if (pages == 0 || pages > STACK_MAX_PAGES) {
+        return nullptr;
+    }
+
+    unsigned int flags = CPU::save_and_disable_int();
+    unsigned int* stack = free_lists[pages - 1];
+    if (stack != nullptr) {
+        free_lists[pages - 1] = reinterpret_cast<unsigned int*>(*stack);
+        --free_counts[pages - 1];
+    } else {
+        stack = map(pages);
+    }
+    CPU::restore_int(flags);
+
+    if (stack != nullptr) {
+        bse::memset32(stack, STACK_PATTERN, pages * STACK_PAGE_SIZE / sizeof(unsigned int));
+    }
+    return stack;
+}
+
+void StackPool::free(unsigned int* stack, unsigned int pages) {
+    if (stack == nullptr || pages == 0 || pages > STACK_MAX_PAGES) {
+        return;
+    }
+
+    unsigned int flags = CPU::save_and_disable_int();
+    if (free_counts[pages - 1] < STACK_POOL_KEEP) {
+        *stack = reinterpret_cast<unsigned int>(free_lists[pages - 1]);
+        free_lists[pages - 1] = stack;
+        ++free_counts[pages - 1];
+    } else {
+        // Freeing makes the guard page present again
+        pg_free_pages(stack - STACK_GUARD_PAGES * STACK_PAGE_SIZE / sizeof(unsigned int), pages + STACK_GUARD_PAGES);
+    }
+    CPU::restore_int(flags);
+}
+
+// New stack with guard page directly from the page allocator, has to be called with interrupts disabled
+unsigned int* StackPool::map(unsigned int pages) {
+    unsigned int* stack = pg_alloc_pages(pages + STACK_GUARD_PAGES);
+    if (stack == nullptr) {
+        return nullptr;
+    }
+
+    pg_notpresent_page(stack);  // Overflows fault instead of overwriting the next stack
+    return stack + STACK_GUARD_PAGES * STACK_PAGE_SIZE / sizeof(unsigned int);
+}
+
+void StackPool::reserve(unsigned int pages, unsigned int count) {
+    if (pages == 0 || pages > STACK_MAX_PAGES) {
+        return;
+    }
+
+    // Fresh stacks go straight into the free list, taking them with alloc() would only reuse the first one
+    unsigned int flags = CPU::save_and_disable_int();
+    for (unsigned int i = 0; i < count && free_counts[pages - 1] < STACK_POOL_KEEP; ++i) {
+        unsigned int* stack = map(pages);
+        if (stack == nullptr) {
+            break;
+        }
+        *stack = reinterpret_cast<unsigned int>(free_lists[pages - 1]);
+        free_lists[pages - 1] = stack;
+        ++free_counts[pages - 1];
+    }
+    CPU::restore_int(flags);
+}
+
+unsigned int StackPool::used(const unsigned int* stack, unsigned int pages) {
+    unsigned int words = pages * STACK_PAGE_SIZE / sizeof(unsigned int);
+
+    // The first word links the free list while the stack is unused, start after it
+    unsigned int untouched = 1;
+    while (untouched < words && stack[untouched] == STACK_PATTERN) {
+        ++untouched;
+    }
+    return (words - untouched) * sizeof(unsigned int);
+}
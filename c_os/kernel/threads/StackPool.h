@@ -0,0 +1,61 @@
+/*****************************************************************************
+ *                                                                           *
+ *                             S T A C K P O O L                             *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Verwaltet die Stacks der Threads. Stacks bestehen aus    *
+ *                  ganzen Seiten vom Seitenallokator und werden nach dem    *
+ *                  Beenden eines Threads fuer den naechsten aufgehoben.     *
+ *****************************************************************************/
+
+#ifndef StackPool_include__
+#define StackPool_include__
+
+#include "user/lib/Array.h"
+
+constexpr const unsigned int STACK_PAGE_SIZE = 4096;
+constexpr const unsigned int STACK_DEFAULT_PAGES = 1;  // 4 KiB, like the old heap allocated stacks
+constexpr const unsigned int STACK_MAX_PAGES = 16;     // 64 KiB
+constexpr const unsigned int STACK_POOL_KEEP = 8;      // Free stacks kept per size
+constexpr const unsigned int STACK_GUARD_PAGES = 1;    // Not present page below every stack, see StackGuard
+
+// Fills unused stacks, the high-water mark is found by searching for the first changed word
+constexpr const unsigned int STACK_PATTERN = 0x57AC57AC;
+
+// NOTE: Creating and exiting a thread used to allocate and free its stack on the heap every time.
+//       Stacks are now page aligned blocks of 1 to STACK_MAX_PAGES pages from pg_alloc_pages().
+//       Freed stacks are kept in one free list per size (linked through their first word), so
+//       short-lived threads reuse them without touching the page table.
+//       Below every stack lies a not present guard page that stays unmapped while the stack is in the pool.
+class StackPool {
+private:
+    bse::array<unsigned int*, STACK_MAX_PAGES> free_lists;  // Index is pages - 1
+    bse::array<unsigned int, STACK_MAX_PAGES> free_counts;
+
+    static unsigned int* map(unsigned int pages);
+
+public:
+    StackPool(const StackPool& copy) = delete;
+
+    StackPool() {
+        for (unsigned int i = 0; i < STACK_MAX_PAGES; ++i) {
+            free_lists[i] = nullptr;
+            free_counts[i] = 0;
+        }
+    }
+
+    // Rounds bytes up to whole pages, 0 if the size isn't supported
+    static unsigned int pages_for(unsigned int bytes);
+
+    // Returns a stack of 'pages' pages filled with STACK_PATTERN, nullptr if out of pages
+    unsigned int* alloc(unsigned int pages);
+    void free(unsigned int* stack, unsigned int pages);
+
+    // Allocates 'count' stacks of 'pages' pages in advance (at most STACK_POOL_KEEP are kept)
+    void reserve(unsigned int pages, unsigned int count);
+
+    // Bytes of the stack that were used at some point (stacks grow down from the top)
+    static unsigned int used(const unsigned int* stack, unsigned int pages);
+};
+
+#endif
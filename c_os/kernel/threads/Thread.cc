@@ -21,6 +21,8 @@
  *****************************************************************************/
 
 #include "kernel/threads/Thread.h"
+#include "kernel/CPU.h"
+#include "kernel/Globals.h"
 
 // Funktionen, die auf der Assembler-Ebene implementiert werden, muessen als
 // extern "C" deklariert werden, da sie nicht dem Name-Mangeling von C++
@@ -92,19 +94,56 @@ void Thread_init(unsigned int* esp, unsigned int* stack, void (*kickoff)(Thread*
 /*****************************************************************************
  * Methode:         Coroutine::Coroutine                                     *
  *---------------------------------------------------------------------------*
- * Beschreibung:    Initialer Kontext einer Koroutine einrichten.            *
+ * Beschreibung:    Thread anlegen. Der Stack wird erst vom Scheduler in     *
+ *                  'ready' mit 'init_stack' zugewiesen.                     *
+ *****************************************************************************/
+Thread::Thread(char* name) : esp(0), state_since(CPU::rdtsc()), log(name), name(name), tid(ThreadCnt++) {
+    log.info() << "Initialized thread with ID: " << tid << " (" << name << ")" << endl;
+}
+
+Thread::~Thread() {
+    log.info() << "Uninitialized thread, ID: " << dec << tid << " (" << name << ")" << endl;
+    if (stack == nullptr) {
+        return;
+    }
+
+    unsigned int used = stack_used();
+    if (used >= stack_size()) {
+        // The pattern is gone completely, the thread probably wrote below its stack
+        log.error() << "Stack overflow: used all " << stack_size() << " bytes" << endl;
+    } else {
+        log.info() << "Stack used: " << used << " of " << stack_size() << " bytes" << endl;
+    }
+    stackpool.free(stack, stack_pages);
+}
+
+/*****************************************************************************
+ * Methode:         Thread::init_stack                                       *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Stack aus dem StackPool holen und den initialen Kontext  *
+ *                  einrichten.                                              *
  *                                                                           *
  * Parameter:                                                                *
- *      stack       Stack für die neue Koroutine                             *
+ *      pages       Groesse des Stacks in 4 KB Seiten                        *
  *****************************************************************************/
-Thread::Thread(char* name) : stack(new unsigned int[1024]), esp(0), log(name), name(name), tid(ThreadCnt++) {
+bool Thread::init_stack(unsigned int pages) {
+    stack = stackpool.alloc(pages);
     if (stack == nullptr) {
         log.error() << "Couldn't initialize Thread (couldn't alloc stack)" << endl;
-        return;
+        return false;
     }
+    stack_pages = pages;
 
-    log.info() << "Initialized thread with ID: " << tid << " (" << name << ")" << endl;
-    Thread_init(&esp, &stack[1024], kickoff, this);  // Stack grows from top to bottom
+    unsigned int words = pages * STACK_PAGE_SIZE / sizeof(unsigned int);
+    Thread_init(&esp, &stack[words], kickoff, this);  // Stack grows from top to bottom
+    return true;
+}
+
+unsigned int Thread::stack_used() const {
+    if (stack == nullptr) {
+        return 0;
+    }
+    return StackPool::used(stack, stack_pages);
 }
 
 /*****************************************************************************
@@ -131,3 +170,31 @@ void Thread::start() const {
 
     Thread_start(esp);
 }
+
+/*****************************************************************************
+ * Methode:         Thread::set_state                                        *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Zustand wechseln und die Zeit im bisherigen Zustand      *
+ *                  verbuchen.                                               *
+ *****************************************************************************/
+void Thread::set_state(State next, unsigned long long now) {
+    unsigned long long elapsed = now - state_since;
+
+    switch (state) {
+    case RUNNING:
+        stats.running += elapsed;
+        break;
+    case READY:
+        stats.ready += elapsed;
+        break;
+    case BLOCKED:
+    case SLEEPING:
+        stats.blocked += elapsed;
+        break;
+    case EXITED:
+        break;
+    }
+
+    state = next;
+    state_since = now;
+}
@@ -28,30 +28,77 @@
 #ifndef Thread_include__
 #define Thread_include__
 
+#include "kernel/threads/StackPool.h"
+#include "user/lib/IntrusiveList.h"
 #include "user/lib/utility/Logger.h"
 
-class Thread {
+// Stack size for Scheduler::ready, e.g. scheduler.ready<Worker>(StackSize(16384), ...)
+struct StackSize {
+    unsigned int bytes;
+
+    explicit constexpr StackSize(unsigned int bytes) : bytes(bytes) {}
+};
+
+// The links are used by the scheduler to put the thread into exactly one of its queues
+class Thread : public bse::intrusive_list_node<Thread> {
+public:
+    // Which scheduler queue the thread is in (the running thread is in none)
+    enum State {
+        READY,
+        RUNNING,
+        BLOCKED,
+        SLEEPING,
+        EXITED  // Exited or killed, waits for the reaper or a join (zombie)
+    };
+
+    // CPU accounting, times are rdtsc cycles
+    struct stats_t {
+        unsigned long long running = 0;
+        unsigned long long ready = 0;    // Ready but waiting for the CPU
+        unsigned long long blocked = 0;  // Blocked or sleeping
+        unsigned int voluntary = 0;      // Gave up the CPU (yield, block, sleep)
+        unsigned int involuntary = 0;    // Preempted
+    };
+
 private:
-    unsigned int* stack;
+    unsigned int* stack = nullptr;  // From the StackPool, allocated by the scheduler before the thread is readied
+    unsigned int stack_pages = 0;
     unsigned int esp;
 
+    // Multi-level feedback queue state, managed by the scheduler
+    unsigned int priority = 0;    // Current level, 0 is the highest priority
+    unsigned int slice_used = 0;  // Ticks used from the time slice of the current level
+
+    State state = READY;
+    unsigned long wakeup = 0;  // Tick to wake up at while SLEEPING
+    unsigned int joiner = 0;   // Thread waiting in Scheduler::join for this one, 0 if none
+
+    stats_t stats;
+    unsigned long long state_since;  // rdtsc when the current state was entered
+
+    // Charges the time spent in the current state, only called by the scheduler
+    void set_state(State next, unsigned long long now);
+
+    // Takes a stack from the pool and prepares the first context switch, false if no stack is left
+    bool init_stack(unsigned int pages);
+
 protected:
     Thread(char* name);
 
     NamedLogger log;
 
     bool running = true;     // For soft exit, if thread uses infinite loop inside run(), use this as condition
+    bool background = false;  // Always runs on the lowest scheduler level, promote()/boost() don't move it
     char* name;              // For logging
     unsigned int tid;        // Thread-ID (wird im Konstruktor vergeben)
     friend class Scheduler;  // Scheduler can access tid
+    friend class ThreadTable;
+    friend class TimerWheel;
 
 public:
     Thread(const Thread& copy) = delete;  // Verhindere Kopieren
 
-    virtual ~Thread() {
-        log.info() << "Uninitialized thread, ID: " << dec << tid << " (" << name << ")" << endl;
-        delete[] stack;
-    }
+    virtual ~Thread();
 
     // Thread aktivieren
     void start() const;
@@ -59,6 +106,20 @@ public:
     // Umschalten auf Thread 'next'
     void switchTo(Thread& next);
 
+    State get_state() const { return state; }
+    const stats_t& get_stats() const { return stats; }
+
+    // High-water mark, the deepest the stack has been used so far
+    unsigned int stack_used() const;
+    unsigned int stack_size() const { return stack_pages * STACK_PAGE_SIZE; }
+    unsigned int* stack_top() const { return stack + stack_pages * STACK_PAGE_SIZE / sizeof(unsigned int); }
+
+    // True if address lies in the guard page below the stack
+    bool in_guard_page(unsigned int address) const {
+        unsigned int bottom = reinterpret_cast<unsigned int>(stack);
+        return stack != nullptr && address < bottom && address >= bottom - STACK_PAGE_SIZE;
+    }
+
     // Ask thread to terminate itself
     void suicide() { running = false; }
 
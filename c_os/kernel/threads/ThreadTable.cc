@@ -0,0 +1,58 @@
+#include "kernel/threads/ThreadTable.h"
+
+int ThreadTable::slot_of(unsigned int tid) const {
+    unsigned int slot = home(tid);
+    for (unsigned int i = 0; i < SIZE; ++i) {
+        if (slots[slot] == nullptr) {
+            return -1;
+        }
+        if (slots[slot]->tid == tid) {
+            return static_cast<int>(slot);
+        }
+        slot = next(slot);
+    }
+    return -1;
+}
+
+bool ThreadTable::insert(Thread& thread) {
+    if (count == SIZE) {
+        return false;
+    }
+
+    unsigned int slot = home(thread.tid);
+    while (slots[slot] != nullptr) {
+        slot = next(slot);
+    }
+    slots[slot] = &thread;
+    ++count;
+    return true;
+}
+
+void ThreadTable::remove(unsigned int tid) {
+    int found = slot_of(tid);
+    if (found < 0) {
+        return;
+    }
+
+    // Move following entries of the probe sequence into the hole if their home slot allows it
+    unsigned int hole = found;
+    unsigned int slot = next(hole);
+    while (slots[slot] != nullptr) {
+        unsigned int want = home(slots[slot]->tid);
+
+        // The entry can fill the hole if its home isn't cyclically between the hole and its slot
+        bool movable = (hole <= slot) ? (want <= hole || want > slot) : (want <= hole && want > slot);
+        if (movable) {
+            slots[hole] = slots[slot];
+            hole = slot;
+        }
+        slot = next(slot);
+    }
+    slots[hole] = nullptr;
+    --count;
+}
+
+Thread* ThreadTable::find(unsigned int tid) const {
+    int slot = slot_of(tid);
+    return slot < 0 ? nullptr : slots[slot];
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************
+ *                                                                           *
+ *                          T H R E A D T A B L E                            *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Abbildung von Thread-IDs auf Thread-Objekte, damit der   *
+ *                  Scheduler Threads nicht in allen Warteschlangen suchen   *
+ *                  muss.                                                    *
+ *****************************************************************************/
+
+#ifndef ThreadTable_include__
+#define ThreadTable_include__
+
+#include "kernel/threads/Thread.h"
+#include "user/lib/Array.h"
+
+// NOTE: Open addressing with linear probing, deletion shifts the following entries back so no
+//       tombstones are needed. The tids are handed out sequentially, so tid % size is already a
+//       perfect hash as long as there are no long-living threads from much earlier "generations".
+//       The table doesn't allocate, so it can be used with interrupts disabled.
+class ThreadTable {
+public:
+    static constexpr const unsigned int SIZE = 256;  // Maximum number of threads, power of 2
+
+private:
+    bse::array<Thread*, SIZE> slots;
+    unsigned int count = 0;
+
+    static unsigned int home(unsigned int tid) { return tid & (SIZE - 1); }
+    static unsigned int next(unsigned int slot) { return (slot + 1) & (SIZE - 1); }
+
+    int slot_of(unsigned int tid) const;  // -1 if not found
+
+public:
+    ThreadTable(const ThreadTable& copy) = delete;
+
+    ThreadTable() {
+        for (Thread*& slot : slots) {
+            slot = nullptr;
+        }
+    }
+
+    bool insert(Thread& thread);  // false if the table is full
+    void remove(unsigned int tid);
+    Thread* find(unsigned int tid) const;  // nullptr if not found
+
+    unsigned int size() const { return count; }
+
+    // Calls f(Thread&) for every thread, in no particular order
+    template<typename F>
+    void for_each(F f) const {
+        for (Thread* thread : slots) {
+            if (thread != nullptr) {
+                f(*thread);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "kernel/threads/TimerWheel.h"
+
+void TimerWheel::place(Thread& thread) {
+    unsigned long delta = thread.wakeup - now;
+
+    unsigned int level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << ((level + 1) * SLOT_BITS))) {
+        ++level;
+    }
+
+    wheel[level][slot(thread.wakeup, level)].push_back(thread);
+}
+
+void TimerWheel::insert(Thread& thread, unsigned long deadline) {
+    if (deadline <= now) {
+        deadline = now + 1;  // The slot for now was already processed
+    }
+    if (deadline - now > MAX_DELTA) {
+        deadline = now + MAX_DELTA;
+    }
+
+    thread.wakeup = deadline;
+    place(thread);
+}
+
+void TimerWheel::advance(unsigned long until, bse::intrusive_list<Thread>& expired) {
+    while (now < until) {
+        ++now;
+
+        // Cascade the higher levels down when the lower level wrapped around
+        for (unsigned int level = 1; level < LEVELS; ++level) {
+            if (slot(now, level - 1) != 0) {
+                break;
+            }
+
+            bse::intrusive_list<Thread>& bucket = wheel[level][slot(now, level)];
+            while (Thread* thread = bucket.pop_front()) {
+                place(*thread);  // Threads that expire now land in the level 0 slot below
+            }
+        }
+
+        expired.splice_back(wheel[0][slot(now, 0)]);
+    }
+}
+
+unsigned int TimerWheel::ticks_until_next(unsigned int max) const {
+    for (unsigned int delta = 1; delta < max; ++delta) {
+        unsigned long tick = now + delta;
+
+        if (!wheel[0][slot(tick, 0)].empty()) {
+            return delta;
+        }
+
+        // A cascade at this tick could move threads into level 0
+        for (unsigned int level = 1; level < LEVELS && slot(tick, level - 1) == 0; ++level) {
+            if (!wheel[level][slot(tick, level)].empty()) {
+                return delta;
+            }
+        }
+    }
+    return max;
+}
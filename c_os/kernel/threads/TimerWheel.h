@@ -0,0 +1,58 @@
+/*****************************************************************************
+ *                                                                           *
+ *                           T I M E R W H E E L                             *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Hierarchisches Timer-Rad fuer schlafende Threads. Wird   *
+ *                  vom Scheduler bei jedem Tick des PITs weitergedreht.     *
+ *****************************************************************************/
+
+#ifndef TimerWheel_include__
+#define TimerWheel_include__
+
+#include "kernel/threads/Thread.h"
+#include "user/lib/Array.h"
+#include "user/lib/IntrusiveList.h"
+
+// NOTE: Level 0 has one slot per tick for the next 64 ticks, every higher level has one slot per
+//       64^level ticks. Threads are inserted in the lowest level that can hold their deadline and
+//       move down a level (cascade) each time the lower level wraps around, so inserting and
+//       expiring is O(1) and every thread is moved at most LEVELS - 1 times.
+//       Sleeping threads are linked into the slots with the same links the scheduler queues use.
+class TimerWheel {
+public:
+    static constexpr const unsigned int LEVELS = 4;
+    static constexpr const unsigned int SLOT_BITS = 6;
+    static constexpr const unsigned int SLOTS = 1U << SLOT_BITS;
+
+    // Longer sleeps are clamped to this (about 46h with 10ms ticks)
+    static constexpr const unsigned long MAX_DELTA = (1UL << (LEVELS * SLOT_BITS)) - 1;
+
+private:
+    bse::array<bse::array<bse::intrusive_list<Thread>, SLOTS>, LEVELS> wheel;
+    unsigned long now = 0;  // Last tick that was processed
+
+    static unsigned int slot(unsigned long tick, unsigned int level) {
+        return (tick >> (level * SLOT_BITS)) & (SLOTS - 1);
+    }
+
+    void place(Thread& thread);  // Inserts relative to now, deadline has to be > now
+
+public:
+    TimerWheel(const TimerWheel& copy) = delete;
+
+    TimerWheel() = default;
+
+    unsigned long current() const { return now; }
+
+    // Thread must not be linked into any other list
+    void insert(Thread& thread, unsigned long deadline);
+
+    // Processes all ticks up to (including) 'until', expired threads are moved to 'expired'
+    void advance(unsigned long until, bse::intrusive_list<Thread>& expired);
+
+    // Ticks until something could expire, 'max' if nothing happens earlier
+    unsigned int ticks_until_next(unsigned int max) const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+/*****************************************************************************
+ *                                                                           *
+ *                            W A I T Q U E U E                              *
+ *                                                                           *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Warteschlange fuer blockierte Threads (FIFO). Wird vom   *
+ *                  Scheduler und von Semaphoren verwendet, ein Thread wird  *
+ *                  mit 'Scheduler::block(queue)' eingetragen und mit        *
+ *                  'Scheduler::wake_one(queue)' wieder aufgeweckt.          *
+ *****************************************************************************/
+
+#ifndef WaitQueue_include__
+#define WaitQueue_include__
+
+#include "kernel/threads/Thread.h"
+#include "user/lib/IntrusiveList.h"
+
+// NOTE: The links live in the Thread object (the same ones the ready queues use, a blocked thread
+//       is in no other queue), so waiting never allocates and waking the first thread is O(1).
+//       A thread can also be removed from the middle (deblock, kill) without knowing the queue.
+//       The queue is only modified by the scheduler with interrupts disabled.
+class WaitQueue {
+private:
+    bse::intrusive_list<Thread> threads;
+
+    friend class Scheduler;
+
+public:
+    WaitQueue(const WaitQueue& copy) = delete;  // Verhindere Kopieren
+
+    WaitQueue() = default;
+
+    bool empty() const { return threads.empty(); }
+};
+
+#endif
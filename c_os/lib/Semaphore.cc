@@ -9,33 +9,28 @@ void Semaphore::p() {
         // Semaphore can be acquired
         counter = counter - 1;
         lock.release();
+        Trace::event(Trace::SEM_P, reinterpret_cast<unsigned int>(this), 0);
     } else {
         // Block and manage thread in semaphore queue until it's woken up by v() again
-        if (!wait_queue.initialized()) {  // TODO: I will replace this suboptimal datastructure in the future
-            wait_queue.reserve();
-        }
-        wait_queue.push_back(scheduler.get_active());
+        Trace::event(Trace::SEM_P, reinterpret_cast<unsigned int>(this), 1);
 
         CPU::disable_int();  // Make sure the block() comes through after releasing the lock
         lock.release();
-        scheduler.block();  // Moves to next thread, enables int
+        scheduler.block(wait_queue);  // Moves to next thread, enables int
     }
 }
 
 void Semaphore::v() {
     lock.acquire();
 
-    if (!wait_queue.empty()) {
-        // Semaphore stays busy and unblocks next thread to work in critical section
-        unsigned int tid = wait_queue.front();
-        wait_queue.erase(wait_queue.begin());
-
-        CPU::disable_int();  // Make sure the deblock() comes through after releasing the lock
-        lock.release();
-        scheduler.deblock(tid);  // Enables int
-    } else {
+    // Semaphore stays busy and unblocks next thread to work in critical section
+    CPU::disable_int();  // Make sure the wakeup comes through after releasing the lock
+    unsigned int tid = scheduler.wake_one(wait_queue);  // Keeps int disabled
+    if (tid == 0) {
         // No more threads want to work so free semaphore
         counter = counter + 1;
-        lock.release();
     }
+    lock.release();
+    CPU::enable_int();
+    Trace::event(Trace::SEM_V, reinterpret_cast<unsigned int>(this), tid);
 }
@@ -11,14 +11,13 @@
 #ifndef Semaphore_include__
 #define Semaphore_include__
 
-#include "kernel/threads/Thread.h"
+#include "kernel/threads/WaitQueue.h"
 #include "lib/SpinLock.h"
-#include "user/lib/Vector.h"
 
 class Semaphore {
 private:
-    // Queue fuer wartende Threads.
-    bse::vector<unsigned int> wait_queue;
+    // Queue fuer wartende Threads (FIFO, die Verkettung liegt in den Threads selbst)
+    WaitQueue wait_queue;
     SpinLock lock;
 
     int counter;
@@ -27,7 +26,7 @@ public:
     Semaphore(const Semaphore& copy) = delete;  // Verhindere Kopieren
 
     // Konstruktor: Initialisieren des Semaphorzaehlers
-    Semaphore(int c) : wait_queue(true), counter(c) {}
+    Semaphore(int c) : counter(c) {}
 
     // 'Passieren': Warten auf das Freiwerden eines kritischen Abschnitts.
     void p();
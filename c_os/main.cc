@@ -11,8 +11,18 @@
  *****************************************************************************/
 
 #include "kernel/Globals.h"
+#include "kernel/threads/LogDrainThread.h"
+#include "kernel/threads/ReaperThread.h"
+#include "user/demo/SchedBenchmark.h"
 #include "user/MainMenu.h"
 
+// Set by 'make BENCH=1': Runs the scheduler benchmark instead of the menu and exits qemu afterwards
+#ifdef HEADLESS_BENCHMARK
+constexpr const bool HEADLESS = true;
+#else
+constexpr const bool HEADLESS = false;
+#endif
+
 void print_startup_message() {
     kout.lock();
     kout.clear();
@@ -46,26 +56,34 @@ int main() {
 
     // Speicherverwaltung initialisieren
     allocator.init();
-    scheduler.init();
     kevman.init();
 
     // Tastatur-Unterbrechungsroutine 'einstoepseln'
     kb.plugin();
     pit.plugin();
+    serial.plugin();
 
-    // Interrupts erlauben (Tastatur, PIT)
+    // Interrupts erlauben (Tastatur, PIT, COM1)
     CPU::enable_int();
 
     // Activate paging
     // This has to happen after the allocator is initialized but before the scheduler is started
     pg_init();
+    stackpool.reserve(STACK_DEFAULT_PAGES, STACK_POOL_KEEP);  // Creating the first threads doesn't have to search the page table
+    sg_init();  // Stack overflows into the guard pages only kill the thread
 
     // Startmeldung
     print_startup_message();
 
     // Scheduler starten (schedule() erzeugt den Idle-Thread)
-    scheduler.ready<MainMenu>();  // NOTE: A thread that manages other threads has to be added before scheduler.schedule(),
-                                  //       because scheduler.schedule() doesn't return, only threads get cpu time
+    scheduler.ready<LogDrainThread>();  // Writes the log in the background from now on
+    scheduler.ready<ReaperThread>();    // Destroys exited threads
+    if constexpr (HEADLESS) {
+        scheduler.ready<SchedBenchmark>(true);
+    } else {
+        scheduler.ready<MainMenu>();  // NOTE: A thread that manages other threads has to be added before scheduler.schedule(),
+                                      //       because scheduler.schedule() doesn't return, only threads get cpu time
+    }
     scheduler.schedule();
 
     // NOTE: Enforced ToDo's (needed)
@@ -81,13 +99,13 @@ int main() {
     //
     // DONE: Serial output
     // CANCELED: Output graphviz stuff over serial?
-    // CANCELED: Fix the damn TreeAllocator: Allow root deletion without bluescreen
+    // DONE: Fix the damn TreeAllocator: Allow root deletion without bluescreen
     //           Maybe just remove the red black tree stuff and replace with usual binary search tree?
     //           I can just balance this tree unefficiantly by reinserting all nodes
     // CANCELED: Implement BST data structure with Tree interface?
     // CANCELED: Implement RBT tree interface implementation?
     // CANCELED: Switch treealloc so the underlying tree can be swapped easily
-    // CANCELED: Implement realloc so ArrayList can realloc instead of newly allocate bigger block
+    // DONE: Implement realloc so ArrayList can realloc instead of newly allocate bigger block
     // DONE: Array wrapper
     // DONE: Rewrite Logging with a basic logger
     // DONE: Static Logger
@@ -40,6 +40,9 @@ MULTIBOOT_EAX_MAGIC	equ	0x2badb002
 [GLOBAL paging_on]
 [GLOBAL get_page_fault_address]
 [GLOBAL get_int_esp]
+[GLOBAL gdt]
+[GLOBAL tss_load]
+[GLOBAL double_fault_entry]
 
 
 ; Michael Schoettner:
@@ -50,6 +53,7 @@ MULTIBOOT_EAX_MAGIC	equ	0x2badb002
 
 [EXTERN main]
 [EXTERN int_disp]
+[EXTERN double_fault]
 
 [EXTERN ___BSS_START__]
 [EXTERN ___BSS_END__]
@@ -176,6 +180,16 @@ wrapper_body:
     popad	        ; alle Register wiederherstellen
     iret            ; fertig!
 
+; Einsprung des Double-Fault-Tasks (Task-Gate in IDT-Eintrag 8, siehe StackGuard.cc)
+; Der Task laeuft auf einem eigenen Stack, daher funktioniert er auch, wenn der
+; Stack des unterbrochenen Threads voll ist. Nach dem iret setzt der Task beim
+; naechsten Double Fault hinter dem iret fort, daher die Schleife.
+double_fault_entry:
+    add esp,4       ; Error-Code (immer 0) entfernen
+    call double_fault
+    iret            ; Task-Wechsel zurueck (ueber den Back-Link im TSS)
+    jmp double_fault_entry
+
 ;
 ; setup_idt
 ;
@@ -294,6 +308,16 @@ invalidate_tlb_entry:
  	invlpg 	[eax]
 	ret
 
+; GDT neu laden (enthaelt jetzt die TSS-Deskriptoren) und das TSS
+; des Kernels setzen (siehe StackGuard.cc)
+;
+; C Prototyp: void tss_load (unsigned int selector);
+tss_load:
+    lgdt [gdt_48]
+    mov eax,[4+esp]     ; Selektor des Kernel-TSS
+    ltr ax
+    ret
+
 ; Auslesen von 'int_esp'
 ; wird im Bluescreen benoetigt, um den Stacks zuzugreifen
 ;
@@ -359,8 +383,11 @@ gdt:
     dw  09A02h      ; 0x2 -> base address =0x24000 (siehe BIOS.cc) und code read/exec;
     dw  0008Fh      ; granularity=4096, 16-bit code
 
+    dw  0,0,0,0     ; 0x20: TSS des Kernels (wird in StackGuard.cc gesetzt)
+    dw  0,0,0,0     ; 0x28: TSS des Double-Fault-Tasks
+
 gdt_48:
-	dw	0x20		; GDT Limit=24, 3 GDT Eintraege
+	dw	0x30		; GDT Limit, 6 GDT Eintraege
 	dd	gdt         ; Physikalische Adresse der GDT
 
 
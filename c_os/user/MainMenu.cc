@@ -2,12 +2,15 @@
 #include "user/demo/ArrayDemo.h"
 #include "user/demo/HeapDemo.h"
 #include "user/demo/KeyboardDemo.h"
+#include "user/demo/MemoryDemo.h"
 #include "user/demo/PagingDemo.h"
 #include "user/demo/PCSPKdemo.h"
 #include "user/demo/PreemptiveThreadDemo.h"
+#include "user/demo/SchedBenchmark.h"
 #include "user/demo/SmartPointerDemo.h"
 #include "user/demo/StringDemo.h"
 #include "user/demo/TextDemo.h"
+#include "user/demo/TopView.h"
 #include "user/demo/VBEdemo.h"
 #include "user/demo/VectorDemo.h"
 
@@ -27,6 +30,12 @@ void print_demo_menu() {
          << "9 - bse::array demo\n"
          << "0 - bse::unique_ptr demo\n"
          << "! - bse::string demo\n"
+         << "m - Memory benchmark\n"
+         << "b - Scheduler benchmark\n"
+         << "u - Thread CPU usage (top)\n"
+         << "[/] - Scroll back/forward\n"
+         << "t - Start/stop event trace (COM2)\n"
+         << "p/P - Start/stop profiler, dump profile to serial\n"
          << endl;
     kout.unlock();
 }
@@ -76,15 +85,40 @@ void MainMenu::run() {
                 running_demo = scheduler.ready<StringDemo>();
                 break;
             }
+        } else if (input == 'm') {
+            running_demo = scheduler.ready<MemoryDemo>();
+        } else if (input == 'b') {
+            running_demo = scheduler.ready<SchedBenchmark>(false);
+        } else if (input == 'u') {
+            running_demo = scheduler.ready<TopView>(StackSize(8192));  // Keeps a snapshot of all threads on the stack
+        } else if (input == 't') {
+            if (Trace::running()) {
+                Trace::stop();
+            } else {
+                Trace::start();
+            }
+        } else if (input == 'p') {
+            if (Profiler::running()) {
+                Profiler::stop();
+            } else {
+                Profiler::start();
+            }
+        } else if (input == 'P') {
+            Profiler::dump();
+        } else if (input == '[') {
+            CGA::scrollback(CGA::ROWS / 2);
+        } else if (input == ']') {
+            CGA::scrollback(-CGA::ROWS / 2);
         } else if (input == 'k') {
-            scheduler.nice_kill(running_demo);  // NOTE: If thread exits itself this will throw error
+            // NOTE: Not all demos check running, don't wait for them so 'K' still works, the reaper collects them
+            scheduler.nice_kill(running_demo);
             print_demo_menu();
         } else if (input == 'K') {
             scheduler.kill(running_demo);
+            scheduler.join(running_demo);  // Already a zombie, doesn't block
             print_demo_menu();
         }
     }
 
     scheduler.exit();
-    // This thread won't be deleted...
 }
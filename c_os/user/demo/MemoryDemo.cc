@@ -0,0 +1,87 @@
+#include "user/demo/MemoryDemo.h"
+#include "kernel/CPU.h"
+#include "user/lib/mem/Memory.h"
+
+constexpr const unsigned int BENCH_RUNS = 16;
+constexpr const unsigned int BENCH_BYTES = 64 * 1024;
+
+// The old implementations
+void loop_memcpy(char* destination, const char* source, std::size_t bytes) {
+    for (unsigned int i = 0; i < bytes; ++i) {
+        *(destination + i) = *(source + i);
+    }
+}
+
+void loop_memmove_backward(char* destination, const char* source, std::size_t bytes) {
+    for (std::size_t byte = bytes; byte > 0; --byte) {
+        destination[byte - 1] = source[byte - 1];
+    }
+}
+
+void loop_memset(char* destination, char value, std::size_t bytes) {
+    for (std::size_t byte = 0; byte < bytes; ++byte) {
+        *(destination + byte) = value;
+    }
+}
+
+// Fastest of multiple runs, so an interrupt doesn't ruin the result
+template<typename F>
+unsigned long measure(F func) {
+    unsigned long long best = ~0ULL;
+    for (unsigned int run = 0; run < BENCH_RUNS; ++run) {
+        unsigned long long start = CPU::rdtsc();
+        func();
+        unsigned long long cycles = CPU::rdtsc() - start;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    return static_cast<unsigned long>(best);
+}
+
+void print_result(const char* name, std::size_t bytes, unsigned long old_cycles, unsigned long new_cycles) {
+    kout << fillw(14) << name << fillw(0) << " " << fillw(6) << dec << bytes << fillw(0) << " B: "
+         << fillw(9) << old_cycles << fillw(0) << " -> " << fillw(9) << new_cycles << fillw(0)
+         << " cycles (x" << (new_cycles == 0 ? 0 : old_cycles / new_cycles) << ")" << endl;
+}
+
+void MemoryDemo::run() {
+    char* source = new char[BENCH_BYTES + 4];
+    char* destination = new char[BENCH_BYTES + 4];
+
+    kout.lock();
+    kout.clear();
+    kout << "Memory Benchmark (rdtsc, best of " << dec << BENCH_RUNS << " runs)" << endl;
+    kout << "               Size       Loop        rep movs/stos" << endl;
+
+    for (std::size_t bytes : {64U, 4000U, BENCH_BYTES}) {
+        print_result("memcpy", bytes,
+                     measure([=] { loop_memcpy(destination, source, bytes); }),
+                     measure([=] { bse::memcpy_bytes(destination, source, bytes); }));
+
+        // Unaligned source and destination, only the destination gets aligned
+        print_result("memcpy+1", bytes,
+                     measure([=] { loop_memcpy(destination + 1, source + 3, bytes); }),
+                     measure([=] { bse::memcpy_bytes(destination + 1, source + 3, bytes); }));
+
+        // Overlapping regions, copies backwards
+        print_result("memmove", bytes,
+                     measure([=] { loop_memmove_backward(destination + 4, destination, bytes); }),
+                     measure([=] { bse::memmove(destination + 4, destination, bytes); }));
+
+        print_result("memset", bytes,
+                     measure([=] { loop_memset(destination, 'x', bytes); }),
+                     measure([=] { bse::memset(destination, 'x', bytes); }));
+
+        print_result("memset32", bytes,
+                     measure([=] { loop_memset(destination, 'x', bytes); }),
+                     measure([=] { bse::memset32(reinterpret_cast<unsigned int*>(destination), 0, bytes / 4); }));
+    }
+
+    kout.unlock();
+
+    delete[] source;
+    delete[] destination;
+
+    scheduler.exit();
+}
@@ -0,0 +1,16 @@
+#ifndef MemoryDemo_include__
+#define MemoryDemo_include__
+
+#include "kernel/Globals.h"
+
+// Compares the rep movsd/stosd based memory functions against plain loops
+class MemoryDemo : public Thread {
+public:
+    MemoryDemo(const MemoryDemo& copy) = delete;
+
+    MemoryDemo() : Thread("MemoryDemo") {}
+
+    void run() override;
+};
+
+#endif
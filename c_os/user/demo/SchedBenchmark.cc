@@ -0,0 +1,294 @@
+#include "user/demo/SchedBenchmark.h"
+#include "kernel/CPU.h"
+#include "kernel/IOport.h"
+
+constexpr const unsigned int BENCH_WARMUP = 16;
+constexpr const unsigned long long BENCH_GAP = 20000;  // Cycles without the loop running, the thread was interrupted
+
+// Appends text to a line buffer, returns the new end
+char* append(char* pos, const char* text) {
+    while (*text != '\0') {
+        *pos++ = *text++;
+    }
+    return pos;
+}
+
+char* append(char* pos, unsigned int value) {
+    char digits[10];
+    unsigned int len = 0;
+    do {
+        digits[len++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (len > 0) {
+        *pos++ = digits[--len];
+    }
+    return pos;
+}
+
+unsigned int cycles_since(unsigned long long start) {
+    unsigned long long cycles = CPU::rdtsc() - start;
+    return cycles > 0xFFFFFFFFULL ? 0xFFFFFFFFU : static_cast<unsigned int>(cycles);
+}
+
+void BenchPartner::run() {
+    switch (mode) {
+    case SchedBenchmark::YIELD:
+        while (!bench.stop) {
+            scheduler.yield();
+        }
+        break;
+    case SchedBenchmark::SEMAPHORE:
+        while (true) {
+            bench.ping.p();
+            if (bench.stop) {
+                break;
+            }
+            bench.pong.v();
+        }
+        break;
+    case SchedBenchmark::BLOCK:
+        while (true) {
+            // Interrupts stay disabled until the thread is blocked, so the benchmark
+            // thread can't deblock it too early
+            CPU::disable_int();
+            bench.partner_parked = true;
+            scheduler.block();
+            if (bench.stop) {
+                break;
+            }
+
+            while (!bench.bench_parked) {
+                scheduler.yield();
+            }
+            bench.bench_parked = false;
+            scheduler.deblock(bench_tid);
+        }
+        break;
+    case SchedBenchmark::SPIN:
+        while (!bench.stop) {
+            bench.spins = bench.spins + 1;
+        }
+        break;
+    }
+
+    scheduler.exit();
+}
+
+unsigned int SchedBenchmark::start_partner(Mode mode) {
+    stop = false;
+    partner_parked = false;
+    bench_parked = false;
+    partner = scheduler.ready<BenchPartner>(this, mode, tid);
+    return partner;
+}
+
+void SchedBenchmark::wait_exited() {
+    scheduler.join(partner);  // The partner is destroyed with the returned pointer
+    partner = 0;
+}
+
+/*****************************************************************************
+ * Methode:         SchedBenchmark::report                                   *
+ *---------------------------------------------------------------------------*
+ * Beschreibung:    Messwerte sortieren und min/median/p99/max als eine      *
+ *                  Zeile ueber die serielle Schnittstelle ausgeben.         *
+ *****************************************************************************/
+void SchedBenchmark::report(const char* name, unsigned int count) {
+    // Insertion sort, there are only a few samples
+    for (unsigned int i = 1; i < count; ++i) {
+        unsigned int value = samples[i];
+        unsigned int j = i;
+        for (; j > 0 && samples[j - 1] > value; --j) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = value;
+    }
+
+    unsigned int p99 = count * 99 / 100;
+    if (p99 >= count) {
+        p99 = count - 1;
+    }
+
+    char line[160];
+    char* pos = append(line, "\r\nBENCH name=");
+    pos = append(pos, name);
+    pos = append(pos, " unit=cycles n=");
+    pos = append(pos, count);
+    pos = append(pos, " min=");
+    pos = append(pos, samples[0]);
+    pos = append(pos, " median=");
+    pos = append(pos, samples[count / 2]);
+    pos = append(pos, " p99=");
+    pos = append(pos, samples[p99]);
+    pos = append(pos, " max=");
+    pos = append(pos, samples[count - 1]);
+    pos = append(pos, "\r\n");
+
+    // Don't let other output end up in the middle of the line
+    CPU::disable_int();
+    SerialOut::write(bse::string_view(line, pos - line));
+    CPU::enable_int();
+
+    kout.lock();
+    kout << fillw(20) << name << fillw(0) << " median: " << dec << samples[count / 2]
+         << " p99: " << samples[p99] << " cycles" << endl;
+    kout.unlock();
+}
+
+// Two threads yielding to each other, one sample is a full round trip
+void SchedBenchmark::yield_roundtrip() {
+    start_partner(YIELD);
+
+    for (unsigned int i = 0; i < BENCH_WARMUP; ++i) {
+        scheduler.yield();
+    }
+    for (unsigned int i = 0; i < BENCH_SAMPLES && running; ++i) {
+        unsigned long long start = CPU::rdtsc();
+        scheduler.yield();
+        samples[i] = cycles_since(start);
+    }
+
+    stop = true;
+    wait_exited();
+    if (running) {
+        report("yield_roundtrip", BENCH_SAMPLES);
+    }
+}
+
+// Ping-pong over two semaphores, one sample is v() -> partner p() -> partner v() -> p()
+void SchedBenchmark::semaphore_handoff() {
+    start_partner(SEMAPHORE);
+
+    for (unsigned int i = 0; i < BENCH_WARMUP + BENCH_SAMPLES && running; ++i) {
+        unsigned long long start = CPU::rdtsc();
+        ping.v();
+        pong.p();
+        if (i >= BENCH_WARMUP) {
+            samples[i - BENCH_WARMUP] = cycles_since(start);
+        }
+    }
+
+    stop = true;
+    ping.v();
+    wait_exited();
+    if (running) {
+        report("semaphore_handoff", BENCH_SAMPLES);
+    }
+}
+
+// Deblock the partner and block, the partner deblocks this thread and blocks again
+void SchedBenchmark::block_deblock() {
+    start_partner(BLOCK);
+
+    for (unsigned int i = 0; i < BENCH_WARMUP + BENCH_SAMPLES && running; ++i) {
+        // The partner has to be blocked before it can be deblocked
+        while (!partner_parked) {
+            scheduler.yield();
+        }
+        partner_parked = false;
+
+        unsigned long long start = CPU::rdtsc();
+        scheduler.deblock(partner);
+        CPU::disable_int();
+        bench_parked = true;
+        scheduler.block();
+        if (i >= BENCH_WARMUP) {
+            samples[i - BENCH_WARMUP] = cycles_since(start);
+        }
+    }
+
+    while (!partner_parked) {
+        scheduler.yield();
+    }
+    stop = true;
+    scheduler.deblock(partner);
+    wait_exited();
+    if (running) {
+        report("block_deblock", BENCH_SAMPLES);
+    }
+}
+
+// Two CPU-bound threads, measures from the timer interrupt until the preempted-in thread runs again
+void SchedBenchmark::preempt_latency() {
+    spins = 0;
+    start_partner(SPIN);
+
+    unsigned int count = 0;
+    unsigned int last_spins = spins;
+    unsigned long long last = CPU::rdtsc();
+    while (count < BENCH_PREEMPT_SAMPLES && running) {
+        unsigned long long now = CPU::rdtsc();
+        if (now - last > BENCH_GAP && spins != last_spins) {
+            // The partner ran in between, so this thread was switched back in by the scheduler
+            unsigned long long tick = pit.last_interrupt();
+            if (tick > last && tick < now) {
+                samples[count++] = static_cast<unsigned int>(now - tick);
+            }
+            last_spins = spins;
+        }
+        last = now;
+    }
+
+    stop = true;
+    wait_exited();
+    if (running) {
+        report("preempt_latency", count);
+    }
+}
+
+// Create a thread, join and destroy it
+void SchedBenchmark::create_exit() {
+    for (unsigned int i = 0; i < BENCH_WARMUP + BENCH_SAMPLES && running; ++i) {
+        unsigned long long start = CPU::rdtsc();
+        unsigned int empty = scheduler.ready<BenchEmptyThread>();
+        scheduler.join(empty);
+        if (i >= BENCH_WARMUP) {
+            samples[i - BENCH_WARMUP] = cycles_since(start);
+        }
+    }
+
+    if (running) {
+        report("create_exit", BENCH_SAMPLES);
+    }
+}
+
+void SchedBenchmark::run() {
+    kout.lock();
+    kout.clear();
+    kout << "Scheduler benchmarks, results are also written to serial\n" << endl;
+    kout.unlock();
+
+    // The log drain thread would add noise
+    Logger::LogLevel level = Logger::level;
+    Logger::set_level(Logger::ERROR);
+
+    // Each benchmark stops early and cleans up its partner if the thread was asked to exit (nice_kill)
+    yield_roundtrip();
+    if (running) {
+        semaphore_handoff();
+    }
+    if (running) {
+        block_deblock();
+    }
+    if (running) {
+        preempt_latency();
+    }
+    if (running) {
+        create_exit();
+    }
+
+    Logger::set_level(level);
+    if (running) {
+        SerialOut::write("BENCH-DONE\r\n");
+
+        if (headless) {
+            // qemu exits with status (value << 1) | 1
+            SerialOut::flush();
+            const IOport debug_exit(0xf4);
+            debug_exit.outb(0);
+        }
+    }
+
+    scheduler.exit();
+}
@@ -0,0 +1,93 @@
+#ifndef SchedBenchmark_include__
+#define SchedBenchmark_include__
+
+#include "kernel/Globals.h"
+#include "kernel/threads/Thread.h"
+#include "lib/Semaphore.h"
+#include "user/lib/Array.h"
+
+constexpr const unsigned int BENCH_SAMPLES = 256;
+constexpr const unsigned int BENCH_PREEMPT_SAMPLES = 64;  // Every sample takes at least one tick
+
+// Measures the scheduler primitives with rdtsc. Results are written to serial as
+// "BENCH name=<name> unit=cycles n=<n> min=<> median=<> p99=<> max=<>" lines,
+// followed by a single "BENCH-DONE" line (parsed by tools/bench.sh).
+class SchedBenchmark : public Thread {
+public:
+    // Partners of the benchmark thread, these are the modes they run in
+    enum Mode {
+        YIELD,
+        SEMAPHORE,
+        BLOCK,
+        SPIN
+    };
+
+private:
+    bool headless;  // Exit qemu when done (isa-debug-exit)
+    unsigned int partner = 0;  // Running partner thread, 0 if none
+
+    bse::array<unsigned int, BENCH_SAMPLES> samples;
+
+    // State shared with the partner threads
+    volatile bool stop = false;
+    volatile bool partner_parked = false;
+    volatile bool bench_parked = false;
+    volatile unsigned int spins = 0;
+    Semaphore ping;
+    Semaphore pong;
+
+    friend class BenchPartner;
+
+    void report(const char* name, unsigned int count);
+
+    void yield_roundtrip();
+    void semaphore_handoff();
+    void block_deblock();
+    void preempt_latency();
+    void create_exit();
+
+    unsigned int start_partner(Mode mode);
+    void wait_exited();
+
+public:
+    SchedBenchmark(const SchedBenchmark& copy) = delete;
+
+    explicit SchedBenchmark(bool headless) : Thread("SchedBenchmark"), headless(headless), ping(0), pong(0) {}
+
+    // If the benchmark was killed the partner would keep running on the destroyed benchmark object
+    ~SchedBenchmark() override {
+        if (partner != 0) {
+            stop = true;
+            scheduler.kill(partner);
+        }
+    }
+
+    void run() override;
+};
+
+class BenchPartner : public Thread {
+private:
+    SchedBenchmark& bench;
+    SchedBenchmark::Mode mode;
+    unsigned int bench_tid;
+
+public:
+    BenchPartner(const BenchPartner& copy) = delete;
+
+    BenchPartner(SchedBenchmark* bench, SchedBenchmark::Mode mode, unsigned int bench_tid)
+        : Thread("BenchPartner"), bench(*bench), mode(mode), bench_tid(bench_tid) {}
+
+    void run() override;
+};
+
+// Exits immediately, for measuring thread creation
+class BenchEmptyThread : public Thread {
+public:
+    BenchEmptyThread(const BenchEmptyThread& copy) = delete;
+
+    BenchEmptyThread() : Thread("BenchEmpty") {}
+
+    void run() override { scheduler.exit(); }
+};
+
+#endif
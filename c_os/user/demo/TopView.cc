@@ -0,0 +1,115 @@
+#include "user/demo/TopView.h"
+
+// Share of total in 1/1000, without 64 bit division
+unsigned int permille(unsigned long long part, unsigned long long total) {
+    while (total >= (1ULL << 22)) {  // 1000 * total has to fit into 32 bit
+        total >>= 1;
+        part >>= 1;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    return static_cast<unsigned int>(part) * 1000 / static_cast<unsigned int>(total);
+}
+
+// Prints the value as percentage with one decimal, left aligned in a column of 8 characters
+void print_permille(unsigned int value) {
+    char text[8];
+    unsigned int len = 0;
+
+    unsigned int whole = value / 10;
+    if (whole >= 100) {
+        text[len++] = '0' + whole / 100;
+    }
+    if (whole >= 10) {
+        text[len++] = '0' + (whole / 10) % 10;
+    }
+    text[len++] = '0' + whole % 10;
+    text[len++] = '.';
+    text[len++] = '0' + value % 10;
+    text[len++] = '%';
+
+    kout << fillw(8) << bse::string_view(text, len);
+}
+
+bse::string_view state_to_string(Thread::State state) {
+    switch (state) {
+    case Thread::READY:
+        return "READY";
+    case Thread::RUNNING:
+        return "RUNNING";
+    case Thread::BLOCKED:
+        return "BLOCKED";
+    case Thread::SLEEPING:
+        return "SLEEP";
+    default:
+        return "EXITED";
+    }
+}
+
+Thread::stats_t TopView::delta(const ThreadInfo& current) const {
+    Thread::stats_t result = current.stats;
+
+    for (unsigned int i = 0; i < previous_count; ++i) {
+        if (previous[i].tid == current.tid) {
+            result.running -= previous[i].stats.running;
+            result.ready -= previous[i].stats.ready;
+            result.blocked -= previous[i].stats.blocked;
+            result.voluntary -= previous[i].stats.voluntary;
+            result.involuntary -= previous[i].stats.involuntary;
+            break;
+        }
+    }
+    return result;
+}
+
+void TopView::run() {
+    bse::array<ThreadInfo, TOP_THREADS> current;
+
+    previous_count = scheduler.snapshot(previous.data(), TOP_THREADS);
+    previous_tsc = CPU::rdtsc();
+
+    while (running) {
+        scheduler.sleep_for(TOP_INTERVAL);
+
+        unsigned int count = scheduler.snapshot(current.data(), TOP_THREADS);
+        unsigned long long now = CPU::rdtsc();
+        unsigned long long interval = now - previous_tsc;
+
+        unsigned int switches = 0;
+        for (unsigned int i = 0; i < count; ++i) {
+            Thread::stats_t d = delta(current[i]);
+            switches += d.voluntary + d.involuntary;
+        }
+
+        kout.lock();
+        kout.clear();
+        kout << "Threads: " << dec << count << ", switches in the last second: " << switches
+             << " (k to exit)\n\n";
+        kout << "TID  NAME            STATE   LVL CPU     READY   BLOCKED VOL   INVOL STACK\n";
+
+        for (unsigned int i = 0; i < count; ++i) {
+            const ThreadInfo& info = current[i];
+            Thread::stats_t d = delta(info);
+
+            kout << fillw(5) << dec << info.tid << fillw(16) << info.name
+                 << fillw(8) << state_to_string(info.state) << fillw(4) << info.priority;
+            print_permille(permille(d.running, interval));
+            print_permille(permille(d.ready, interval));
+            print_permille(permille(d.blocked, interval));
+            kout << fillw(6) << d.voluntary << fillw(6) << d.involuntary;
+            print_permille(permille(info.stack_used, info.stack_size));  // High-water mark
+            kout << fillw(0) << "\n";
+        }
+        kout << endl;
+        kout.unlock();
+
+        for (unsigned int i = 0; i < count; ++i) {
+            previous[i] = current[i];
+        }
+        previous_count = count;
+        previous_tsc = now;
+    }
+
+    scheduler.exit();
+}
@@ -0,0 +1,27 @@
+#ifndef TopView_include__
+#define TopView_include__
+
+#include "kernel/Globals.h"
+
+constexpr const unsigned int TOP_INTERVAL = 100;  // Refresh every second
+constexpr const unsigned int TOP_THREADS = 20;    // Fits on the screen
+
+// Shows the CPU usage of all threads over the last interval, like top
+class TopView : public Thread {
+private:
+    bse::array<ThreadInfo, TOP_THREADS> previous;
+    unsigned int previous_count = 0;
+    unsigned long long previous_tsc = 0;
+
+    // Last interval of the thread (everything since it was started for new threads)
+    Thread::stats_t delta(const ThreadInfo& current) const;
+
+public:
+    TopView(const TopView& copy) = delete;
+
+    TopView() : Thread("TopView") {}
+
+    void run() override;
+};
+
+#endif
@@ -81,6 +81,10 @@ void VBEdemo::drawFonts() {
     vesa.drawString(sun_font_8x16, 0, 360, 0, "SUN FONT 8x16", 13);
     vesa.drawString(sun_font_12x22, 0, 380, 0, "SUN FONT 12x22", 14);
     vesa.drawString(pearl_font_8x8, 0, 400, 0, "PEARL FONT 8x8", 14);
+
+    // Opaque text from the glyph cache
+    vesa.drawText(sun_font_12x22, 320, 380, 0xFFFFFF, 0x000000, "CACHED GLYPHS", 13);
+    vesa.drawText(sun_font_8x16, 320, 410, 0x000000, 0xFFFFFF, "Glyph cache 8x16", 16);
 }
 
 /*****************************************************************************
@@ -93,7 +97,9 @@ void VBEdemo::run() {
 
     // In den Grafikmodus schalten (32-Bit Farbtiefe)
     vesa.initGraphicMode(MODE_640_480_24BITS);
-    vesa.setDrawingBuff(BUFFER_VISIBLE);
+
+    // Everything is drawn to the hidden buffer and shown at once
+    vesa.setDrawingBuff(BUFFER_INVISIBLE);
 
     drawColors();
 
@@ -101,8 +107,25 @@ void VBEdemo::run() {
     vesa.drawRectangle(100, 100, 300, 300, 0);
     drawBitmap();
     drawFonts();
+    vesa.fillRectangle(0, 440, vesa.xres - 1, 469, 0xFFFFFF);
+
+    vesa.copyHiddenToVisible();
+
+    // Animate a box until the demo is killed, present() only copies the changed part
+    // of the hidden buffer, so a frame costs a few rows instead of the whole screen
+    unsigned int box_x = 0;
+    int box_dx = 4;
+    while (running) {
+        vesa.fillRectangle(box_x, 445, box_x + 19, 464, 0xFFFFFF);
+        if ((box_dx < 0 && box_x == 0) || (box_dx > 0 && box_x + 20 + box_dx > vesa.xres)) {
+            box_dx = -box_dx;
+        }
+        box_x += box_dx;
+        vesa.fillRectangle(box_x, 445, box_x + 19, 464, 0xFF0000);
 
-    while (running) {}
+        vesa.present();
+        scheduler.sleep_for(2);
+    }
 
     // selbst terminieren
     scheduler.exit();
@@ -26,7 +26,8 @@ public:
     VBEdemo() : Thread("VBEdemo") {}
 
     ~VBEdemo() override {
-        allocator.free(reinterpret_cast<void*>(vesa.hfb));  // Memory is allocated after every start and never deleted, so add that
+        delete[] reinterpret_cast<char*>(vesa.hfb);  // Memory is allocated after every start and never deleted, so add that
+        vesa.flushGlyphs();
         VESA::initTextMode();
     }
 
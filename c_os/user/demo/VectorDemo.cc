@@ -1,6 +1,8 @@
 #include "user/demo/VectorDemo.h"
 
-void print(OutStream& os, const bse::vector<int>& list) {
+// Works with every stream, also with the temporary returned by NamedLogger
+template<typename Stream>
+void print(Stream&& os, const bse::vector<int>& list) {
     os << "Printing List: ";
     for (const int i : list) {
         os << i << " ";
@@ -1,7 +1,19 @@
 #include "user/devices/SerialOut.h"
+#include "kernel/Globals.h"
 
 const IOport SerialOut::com1(0x3f8);
 
+char SerialOut::tx_buf[SerialOut::TX_SIZE];
+unsigned int SerialOut::tx_head = 0;
+unsigned int SerialOut::tx_tail = 0;
+char SerialOut::rx_buf[SerialOut::RX_SIZE];
+unsigned int SerialOut::rx_head = 0;
+unsigned int SerialOut::rx_tail = 0;
+
+bool SerialOut::plugged = false;
+bool SerialOut::tx_active = false;
+WaitQueue SerialOut::readers;
+
 SerialOut::SerialOut() {
     // NOTE: I could add different ports for every register but this was easier as it's that way on OSDev
     com1.outb(1, 0x00);  // Disable all interrupts
@@ -22,6 +34,16 @@ SerialOut::SerialOut() {
     }
 }
 
+void SerialOut::plugin() {
+    intdis.assign(IntDispatcher::com1, *this);
+    PIC::allow(PIC::com1);
+
+    unsigned int flags = CPU::save_and_disable_int();
+    plugged = true;
+    set_interrupts();
+    CPU::restore_int(flags);
+}
+
 int SerialOut::serial_received() {
     return com1.inb(5) & 1;
 }
@@ -30,14 +52,103 @@ int SerialOut::is_transmit_empty() {
     return com1.inb(5) & 0x20;
 }
 
+void SerialOut::set_interrupts() {
+    com1.outb(1, tx_active ? 0x03 : 0x01);  // Received data available (| Transmitter holding register empty)
+}
+
+void SerialOut::fill_fifo() {
+    // The FIFO is completely empty when the THRE bit is set
+    if (is_transmit_empty() == 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < FIFO_SIZE && tx_tail != tx_head; ++i) {
+        com1.outb(tx_buf[tx_tail]);
+        tx_tail = (tx_tail + 1) & (TX_SIZE - 1);
+    }
+}
+
+void SerialOut::trigger() {
+    unsigned char iir;
+
+    // Handle everything the UART has pending, bit 0 is cleared while an interrupt is pending
+    while (((iir = com1.inb(2)) & 1) == 0) {
+        switch ((iir >> 1) & 0x7) {
+        case 0b010:  // Received data available
+        case 0b110:  // Character timeout (less than the threshold in the FIFO)
+            while (serial_received() != 0) {
+                char c = com1.inb();
+                unsigned int next = (rx_head + 1) & (RX_SIZE - 1);
+                if (next != rx_tail) {
+                    rx_buf[rx_head] = c;
+                    rx_head = next;
+                }  // Else dropped, nobody is reading
+            }
+
+            // Every reader checks the buffer again, the ones that come too late block again
+            while (scheduler.wake_one(readers) != 0) {}
+            break;
+        case 0b001:  // Transmitter holding register empty
+            fill_fifo();
+            if (tx_tail == tx_head) {
+                tx_active = false;
+                set_interrupts();
+            }
+            break;
+        case 0b011:  // Line status
+            com1.inb(5);
+            break;
+        case 0b000:  // Modem status
+            com1.inb(6);
+            break;
+        }
+    }
+}
+
 char SerialOut::read() {
-    while (serial_received() == 0) {}
-    return com1.inb();
+    if (!plugged || !scheduler.preemption_enabled()) {
+        while (serial_received() == 0) {}
+        return com1.inb();
+    }
+
+    CPU::disable_int();
+    while (rx_tail == rx_head) {
+        // Checked with interrupts disabled, so the ISR can't deblock before we are blocked
+        scheduler.block(readers);  // Enables interrupts
+        CPU::disable_int();
+    }
+
+    char c = rx_buf[rx_tail];
+    rx_tail = (rx_tail + 1) & (RX_SIZE - 1);
+    CPU::enable_int();
+    return c;
 }
 
 void SerialOut::write(const char a) {
-    while (is_transmit_empty() == 0) {}
-    com1.outb(a);
+    if (!plugged) {
+        while (is_transmit_empty() == 0) {}
+        com1.outb(a);
+        return;
+    }
+
+    unsigned int flags = CPU::save_and_disable_int();
+
+    // Buffer full: Can't wait for the interrupt (might be called with interrupts disabled), so make room by polling
+    while (((tx_head + 1) & (TX_SIZE - 1)) == tx_tail) {
+        fill_fifo();
+    }
+
+    tx_buf[tx_head] = a;
+    tx_head = (tx_head + 1) & (TX_SIZE - 1);
+
+    if (!tx_active) {
+        // The transmitter is idle, start it, the interrupt continues once the FIFO is empty again
+        fill_fifo();
+        tx_active = true;
+        set_interrupts();
+    }
+
+    CPU::restore_int(flags);
 }
 
 void SerialOut::write(const bse::string_view a) {
@@ -45,3 +156,11 @@ void SerialOut::write(const bse::string_view a) {
         write(current);
     }
 }
+
+void SerialOut::flush() {
+    unsigned int flags = CPU::save_and_disable_int();
+    while (tx_tail != tx_head) {
+        fill_fifo();
+    }
+    CPU::restore_int(flags);
+}
@@ -2,27 +2,63 @@
 #define SerialOut_Include_H_
 
 #include "kernel/IOport.h"
+#include "kernel/interrupts/ISR.h"
+#include "kernel/threads/WaitQueue.h"
 #include "user/lib/String.h"
 #include "user/lib/StringView.h"
 
 // NOTE: I took this code from https://wiki.osdev.org/Serial_Ports
 
-class SerialOut {
+// NOTE: Writing and reading goes through software ring buffers. After plugin() the UART raises an
+//       interrupt when its transmit FIFO is empty (refilled with up to 16 bytes at once) and when
+//       bytes were received, so writers don't spin on the line status register for every byte.
+//       Before plugin() (or if the transmit buffer is full) bytes are still written by polling.
+class SerialOut : public ISR {
 private:
     static const IOport com1;
 
+    static constexpr const unsigned int TX_SIZE = 4096;  // Powers of 2
+    static constexpr const unsigned int RX_SIZE = 256;
+    static constexpr const unsigned int FIFO_SIZE = 16;  // 16550 transmit FIFO
+
+    static char tx_buf[TX_SIZE];
+    static unsigned int tx_head;  // Next byte to write
+    static unsigned int tx_tail;  // Next byte to send
+    static char rx_buf[RX_SIZE];
+    static unsigned int rx_head;
+    static unsigned int rx_tail;
+
+    static bool plugged;        // Interrupts are used
+    static bool tx_active;      // Transmitter empty interrupt is enabled
+    static WaitQueue readers;   // Threads blocked in read()
+
     static int serial_received();
     static int is_transmit_empty();
 
+    // Moves up to FIFO_SIZE buffered bytes into the transmit FIFO, has to be called with interrupts disabled
+    static void fill_fifo();
+
+    // Enables the receive interrupt and the transmitter empty interrupt if there is something to send
+    static void set_interrupts();
+
 public:
     SerialOut();
     SerialOut(const SerialOut& copy) = delete;
 
     // Can't make singleton because atexit
 
+    // Registers the COM1 ISR, from here on writing and reading is interrupt driven
+    void plugin();
+
+    void trigger() override;
+
+    // Blocks the calling thread until a byte was received, every byte is only read by one thread
     static char read();
     static void write(char a);
     static void write(const bse::string_view a);
+
+    // Sends everything that is still buffered by polling, e.g. before halting
+    static void flush();
 };
 
 #endif
@@ -3,13 +3,13 @@
 
 void KeyEventManager::subscribe(KeyEventListener& sub) {
     log.debug() << "Subscribe, Thread ID: " << dec << sub.tid << endl;
-    listeners.push_back(&sub);
+    listeners.push_back({sub.tid, &sub});
 }
 
 void KeyEventManager::unsubscribe(KeyEventListener& unsub) {
     log.debug() << "Unsubscribe, Thread ID: " << dec << unsub.tid << endl;
-    for (bse::vector<KeyEventListener*>::iterator it = listeners.begin(); it != listeners.end(); ++it) {
-        if ((*it)->tid == unsub.tid) {
+    for (bse::vector<Subscription>::iterator it = listeners.begin(); it != listeners.end(); ++it) {
+        if (it->tid == unsub.tid) {
             listeners.erase(it);
             return;
         }
@@ -18,9 +18,17 @@ void KeyEventManager::unsubscribe(KeyEventListener& unsub) {
 
 void KeyEventManager::broadcast(char c) {
     log.trace() << "Beginning Broadcast" << endl;
-    for (KeyEventListener* listener : listeners) {
-        log.trace() << "Broadcasting " << c << " to Thread ID: " << dec << listener->tid << endl;
-        listener->trigger(c);
-        scheduler.deblock(listener->tid);
+    for (bse::vector<Subscription>::iterator it = listeners.begin(); it != listeners.end();) {
+        if (!scheduler.alive(it->tid)) {
+            // Thread was killed without unsubscribing, the listener is gone
+            log.debug() << "Removing stale listener of Thread ID: " << dec << it->tid << endl;
+            it = listeners.erase(it);
+            continue;
+        }
+
+        log.trace() << "Broadcasting " << c << " to Thread ID: " << dec << it->tid << endl;
+        it->listener->trigger(c);
+        scheduler.deblock(it->tid);
+        ++it;
     }
 }
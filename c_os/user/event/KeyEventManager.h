@@ -10,9 +10,16 @@
 
 class KeyEventManager {
 private:
-    NamedLogger log;
-
-    bse::vector<KeyEventListener*> listeners;
+    // Called for every keypress, debug messages are only compiled in when needed
+    BasicNamedLogger<Logger::ERROR> log;
+
+    // The tid is stored separately so listeners of killed threads can be detected without
+    // dereferencing the (possibly already deleted) listener
+    struct Subscription {
+        unsigned int tid;
+        KeyEventListener* listener;
+    };
+    bse::vector<Subscription> listeners;
 
 public:
     KeyEventManager(const KeyEventManager& copy) = delete;
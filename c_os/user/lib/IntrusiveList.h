@@ -0,0 +1,143 @@
+#ifndef IntrusiveList_Include_H_
+#define IntrusiveList_Include_H_
+
+// NOTE: The scheduler queues were vectors of unique_ptrs, so every block/exit had to move all following
+//       elements. With the links embedded in the elements themselves every insertion/removal is O(1)
+//       and no allocation is needed at all (so this can also be used inside interrupt handlers).
+//       The list is circular with a sentinel node, so an element can be unlinked without knowing
+//       the list that contains it and whole lists can be spliced in O(1).
+
+#include <utility>
+
+namespace bse {
+
+    template<typename T>
+    class intrusive_list;
+
+    // Has to be inherited by every type that should be stored in an intrusive_list:
+    // class Thread : public bse::intrusive_list_node<Thread> { ... };
+    // An element can only be part of a single list at a time.
+    template<typename T>
+    class intrusive_list_node {
+    private:
+        intrusive_list_node* next = nullptr;
+        intrusive_list_node* prev = nullptr;
+
+        friend class intrusive_list<T>;
+
+    public:
+        intrusive_list_node() = default;
+
+        // Copying would duplicate the links
+        intrusive_list_node(const intrusive_list_node& copy) = delete;
+        intrusive_list_node& operator=(const intrusive_list_node& copy) = delete;
+
+        bool linked() const { return next != nullptr; }
+    };
+
+    template<typename T>
+    class intrusive_list {
+    private:
+        using node_t = intrusive_list_node<T>;
+
+        node_t sentinel;  // sentinel.next is the first, sentinel.prev the last element
+
+        static node_t& node(T& elem) { return static_cast<node_t&>(elem); }
+        static T* elem(node_t* n) { return static_cast<T*>(n); }
+
+        static void link_between(node_t& n, node_t* prev, node_t* next) {
+            n.prev = prev;
+            n.next = next;
+            prev->next = &n;
+            next->prev = &n;
+        }
+
+    public:
+        class iterator {
+        private:
+            node_t* ptr;
+
+        public:
+            iterator(node_t* ptr) : ptr(ptr) {}
+
+            iterator& operator++() {
+                ptr = ptr->next;
+                return *this;
+            }
+
+            T& operator*() { return *elem(ptr); }
+            T* operator->() { return elem(ptr); }
+
+            bool operator==(const iterator& other) const { return ptr == other.ptr; }
+            bool operator!=(const iterator& other) const { return ptr != other.ptr; }
+        };
+
+        intrusive_list() {
+            sentinel.next = &sentinel;
+            sentinel.prev = &sentinel;
+        }
+
+        // The elements point back to the sentinel, so the list can't be copied or moved
+        intrusive_list(const intrusive_list& copy) = delete;
+        intrusive_list& operator=(const intrusive_list& copy) = delete;
+
+        // Don't remove the current element while iterating
+        iterator begin() { return iterator(sentinel.next); }
+        iterator end() { return iterator(&sentinel); }
+
+        void push_back(T& e) { link_between(node(e), sentinel.prev, &sentinel); }
+        void push_front(T& e) { link_between(node(e), &sentinel, sentinel.next); }
+
+        // Works for any list the element is contained in
+        static void remove(T& e) {
+            node_t& n = node(e);
+            n.prev->next = n.next;
+            n.next->prev = n.prev;
+            n.next = nullptr;
+            n.prev = nullptr;
+        }
+
+        // Returns nullptr if the list is empty
+        T* pop_front() {
+            if (empty()) {
+                return nullptr;
+            }
+            T* e = elem(sentinel.next);
+            remove(*e);
+            return e;
+        }
+
+        // Moves all elements of other to the end of this list
+        void splice_back(intrusive_list& other) {
+            if (other.empty()) {
+                return;
+            }
+            node_t* first = other.sentinel.next;
+            node_t* last = other.sentinel.prev;
+
+            first->prev = sentinel.prev;
+            sentinel.prev->next = first;
+            last->next = &sentinel;
+            sentinel.prev = last;
+
+            other.sentinel.next = &other.sentinel;
+            other.sentinel.prev = &other.sentinel;
+        }
+
+        T* front() { return empty() ? nullptr : elem(sentinel.next); }
+
+        bool empty() const { return sentinel.next == &sentinel; }
+
+        // Walks the whole list, only use this for statistics
+        std::size_t size() const {
+            std::size_t count = 0;
+            for (const node_t* n = sentinel.next; n != &sentinel; n = n->next) {
+                ++count;
+            }
+            return count;
+        }
+    };
+
+}  // namespace bse
+
+#endif
@@ -21,6 +21,7 @@ namespace bse {
         // implementation using stringview for everything (OutStream only uses string_view for example)
         string_view(const char* str) : len(strlen(str)), buf(str) {}
         string_view(const string& str) : len(str.size()), buf(static_cast<char*>(str)) {}
+        string_view(const char* str, std::size_t len) : len(len), buf(str) {}
 
         iterator begin() const { return iterator(buf); }
         iterator end() const { return iterator(&buf[len]); }
@@ -5,13 +5,23 @@
 //       Also I wanted to template the Queue (for the scheduler) but with this I can just replace the Queue and use the
 //       ArrayList instead
 
+#include "kernel/Allocator.h"
 #include "user/lib/Iterator.h"
+#include "user/lib/mem/Memory.h"
 #include "user/lib/utility/Logger.h"
+#include <new>
 #include <utility>
 
 // https://en.cppreference.com/w/cpp/container/vector
 namespace bse {
 
+    // NOTE: The buffer is raw memory, only the first buf_pos slots contain constructed elements.
+    //       Elements are created with placement new and destroyed explicitly, so no default
+    //       constructor is needed and unused slots are never touched.
+    //       The capacity is doubled when the buffer is full, first by trying to grow the allocation
+    //       in place, so pushing n elements costs amortized O(1) per element.
+    //       Trivially relocatable elements (see Memory.h) are shifted/moved with a single memmove,
+    //       everything else is move-constructed into the new slot and destroyed in the old one.
     template<typename T>
     class vector {
     public:
@@ -19,85 +29,88 @@ namespace bse {
 
     private:
         static constexpr const std::size_t default_cap = 10;  // Arbitrary but very small because this isn't a real OS :(
-        static constexpr const std::size_t min_cap = 5;       // Slots to allocate extra when array full
+        static constexpr const bool relocatable = is_trivially_relocatable_v<T>;
 
         T* buf = nullptr;  // Heap allocated as size needs to change during runtime
                            // Can't use Array for the same reason so we use a C Style array
         std::size_t buf_pos = 0;
         std::size_t buf_cap = 0;
 
+        static T* allocate(std::size_t cap) {
+            return static_cast<T*>(::operator new(cap * sizeof(T)));
+        }
+
         void init(std::size_t cap = vector::default_cap) {
             if (buf != nullptr) {
                 return;
             }
-            buf = new T[cap];
+            buf = allocate(cap);
             buf_cap = cap;
         }
 
-        std::size_t get_rem_cap() const {
-            return buf_cap - size();
-        }
-
-        // Enlarges the buffer if we run out of space
-        void min_expand() {
-            // Init if necessary
+        // Makes room for at least n more elements
+        void grow(std::size_t n = 1) {
             if (buf == nullptr) {
-                init();
-                return;  // Dont have to realloc after init
+                init(n > vector::default_cap ? n : vector::default_cap);
+                return;
             }
+            if (size() + n <= buf_cap) {
+                return;
+            }
+            switch_buf(size() + n > buf_cap * 2 ? size() + n : buf_cap * 2);
+        }
 
-            // Since we only ever add single elements this should never get below zero
-            if (get_rem_cap() < min_cap) {
-                switch_buf(buf_cap + min_cap);
+        // Moves count elements from src to the raw slots at dst, afterwards src is raw memory
+        static void relocate(T* dst, T* src, std::size_t count) {
+            if constexpr (relocatable) {
+                memmove(dst, src, count * sizeof(T));
+            } else if (dst < src) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    new (&dst[i]) T(std::move(src[i]));
+                    src[i].~T();
+                }
+            } else {
+                // Backwards so overlapping slots are vacated before they are written
+                for (std::size_t i = count; i > 0; --i) {
+                    new (&dst[i - 1]) T(std::move(src[i - 1]));
+                    src[i - 1].~T();
+                }
             }
         }
 
-        // 1. Allocates new buffer
-        // 2. Moves stuff to new buffer
-        // 3. Deletes old buffer
-        // 4. Sets new pos/cap
+        // Changes the capacity to cap (cap >= size())
+        // 1. Tries to grow the allocation without moving it
+        // 2. Otherwise allocates new buffer and moves the elements over
         void switch_buf(std::size_t cap) {
-            // Alloc new array
-            T* new_buf = new T[cap];
-
-            // Swap current elements to new array
-            for (std::size_t i = 0; i < size(); ++i) {
-                new_buf[i] = std::move(buf[i]);
-                buf[i].~T();  // TODO: I think delete[] buf calls these, verify that
+            if (cap > buf_cap && ::try_expand_in_place(buf, cap * sizeof(T))) {
+                buf_cap = cap;
+                return;
             }
 
-            // Move new array to buf, deleting the old array
-            delete[] buf;
+            T* new_buf = allocate(cap);
+            relocate(new_buf, buf, size());
+
+            ::operator delete(buf);
             buf = new_buf;
             buf_cap = cap;
         }
 
-        // Index is location where space should be made
-        void copy_right(std::size_t i) {
-            if (i >= size()) {
-                // We don't need to copy anything as space is already there
-                return;
-            }
-
-            for (std::size_t idx = size(); idx > i; --idx) {
-                buf[idx].~T();                       // Delete previously contained element that will be overridden
-                buf[idx] = std::move(buf[idx - 1]);  // This leaves a "shell" of the old object that has to be deleted
-                buf[idx - 1].~T();                   // Delete element in moved-out state
-            }
+        // Shifts everything from index i on n slots to the right, [i, i + n) is raw memory afterwards
+        // Requires n slots of free capacity
+        void open_gap(std::size_t i, std::size_t n) {
+            relocate(&buf[i + n], &buf[i], size() - i);
         }
 
-        // Index is the location that will be removed
-        void copy_left(std::size_t i) {
-            if (i >= size()) {
-                // We don't need to copy anything as nothing will be overridden
-                return;
-            }
+        // Closes the already destroyed slots [i, i + n) by shifting the following elements to the left
+        void close_gap(std::size_t i, std::size_t n) {
+            relocate(&buf[i], &buf[i + n], size() - i - n);
+        }
 
-            for (std::size_t idx = i; idx < size(); ++idx) {
-                buf[idx].~T();  // Delete the element that will be overwritten
-                buf[idx] = std::move(buf[idx + 1]);
-                buf[idx + 1].~T();
+        void destroy_all() {
+            for (std::size_t i = 0; i < size(); ++i) {
+                buf[i].~T();
             }
+            buf_pos = 0;
         }
 
     public:
@@ -109,31 +122,29 @@ namespace bse {
         };
 
         // Initialize like this: bse::vector<int> vec {1, 2, 3, 4, 5};
-        vector(std::initializer_list<T> list) : buf_cap(list.size()), buf(new T[buf_cap]) {
-            typename std::initializer_list<T>::iterator it = list.begin();
-            for (unsigned int i = 0; i < buf_pos; ++i) {
-                buf[i] = *it;
-                ++it;
+        vector(std::initializer_list<T> list) {
+            init(list.size() > 0 ? list.size() : vector::default_cap);
+            for (const T& elem : list) {
+                new (&buf[buf_pos]) T(elem);
+                ++buf_pos;
             }
         }
 
-
-        vector(const vector& copy) : buf_pos(copy.buf_pos), buf_cap(copy.buf_cap), buf(new T[buf_cap]) {
-            for (unsigned int i = 0; i < buf_pos; ++i) {
-                buf[i] = copy[i];  // Does a copy since copy is marked const reference
+        vector(const vector& copy) {
+            if (copy.buf == nullptr) {
+                return;
+            }
+            init(copy.buf_cap);
+            for (std::size_t i = 0; i < copy.size(); ++i) {
+                new (&buf[i]) T(copy[i]);  // Does a copy since copy is marked const reference
             }
+            buf_pos = copy.buf_pos;
         }
 
         vector& operator=(const vector& copy) {
             if (this != &copy) {
-                ~vector();
-
-                buf_cap = copy.buf_cap;
-                buf_pos = copy.buf_pos;
-                buf = new T[buf_cap];
-                for (unsigned int i = 0; i < buf_pos; ++i) {
-                    buf[i] = copy[i];
-                }
+                vector tmp(copy);
+                *this = std::move(tmp);
             }
             return *this;
         }
@@ -146,6 +157,9 @@ namespace bse {
 
         vector& operator=(vector&& move) noexcept {
             if (this != &move) {
+                destroy_all();
+                ::operator delete(buf);
+
                 buf_cap = move.buf_cap;
                 buf_pos = move.buf_pos;
                 buf = move.buf;
@@ -162,10 +176,8 @@ namespace bse {
                 return;
             }
 
-            for (std::size_t i = 0; i < size(); ++i) {
-                buf[i].~T();  // TODO: I think delete[] buf calls these, verify that
-            }
-            delete[] buf;
+            destroy_all();
+            ::operator delete(buf);
         }
 
         // Iterator
@@ -177,34 +189,55 @@ namespace bse {
         // Add elements
         // https://en.cppreference.com/w/cpp/container/vector/push_back
         void push_back(const T& copy) {
-            buf[size()] = copy;
+            grow();
+            new (&buf[size()]) T(copy);
             ++buf_pos;
-            min_expand();
         }
 
         void push_back(T&& move) {
-            buf[size()] = std::move(move);
+            grow();
+            new (&buf[size()]) T(std::move(move));
             ++buf_pos;
-            min_expand();
         }
 
         // https://en.cppreference.com/w/cpp/container/vector/insert
         // The element will be inserted before the pos iterator, pos can be the end() iterator
         iterator insert(iterator pos, const T& copy) {
-            std::size_t idx = distance(begin(), pos);  // begin() does init if necessary
-            copy_right(idx);                           // nothing will be done if pos == end()
-            buf[idx] = copy;
+            std::size_t idx = buf == nullptr ? 0 : distance(begin(), pos);  // Calculate before the buffer moves
+            grow();
+            open_gap(idx, 1);
+            new (&buf[idx]) T(copy);
             ++buf_pos;
-            min_expand();
             return iterator(&buf[idx]);
         }
 
         iterator insert(iterator pos, T&& move) {
-            std::size_t idx = distance(begin(), pos);  // begin() does init if necessary
-            copy_right(idx);
-            buf[idx] = std::move(move);
+            std::size_t idx = buf == nullptr ? 0 : distance(begin(), pos);  // Calculate before the buffer moves
+            grow();
+            open_gap(idx, 1);
+            new (&buf[idx]) T(std::move(move));
             ++buf_pos;
-            min_expand();
+            return iterator(&buf[idx]);
+        }
+
+        // Inserts copies of [first, last) before pos, the range must not be part of this vector
+        template<typename InputIt>
+        iterator insert(iterator pos, InputIt first, InputIt last) {
+            std::size_t idx = buf == nullptr ? 0 : distance(begin(), pos);
+            std::size_t n = 0;
+            for (InputIt it = first; it != last; ++it) {
+                ++n;
+            }
+            if (n == 0) {
+                return iterator(&buf[idx]);
+            }
+
+            grow(n);
+            open_gap(idx, n);
+            for (std::size_t i = idx; first != last; ++first, ++i) {
+                new (&buf[i]) T(*first);
+            }
+            buf_pos += n;
             return iterator(&buf[idx]);
         }
 
@@ -212,10 +245,18 @@ namespace bse {
         // https://en.cppreference.com/w/cpp/container/vector/erase
         // Returns the iterator after the removed element, pos can't be end() iterator
         iterator erase(iterator pos) {
-            std::size_t idx = distance(begin(), pos);
-            copy_left(idx);
-            --buf_pos;
-            // shrink();
+            return erase(pos, pos + 1);
+        }
+
+        // Removes [first, last), returns the iterator to the element after the removed ones
+        iterator erase(iterator first, iterator last) {
+            std::size_t idx = distance(begin(), first);
+            std::size_t n = distance(first, last);
+            for (std::size_t i = idx; i < idx + n; ++i) {
+                buf[i].~T();
+            }
+            close_gap(idx, n);
+            buf_pos -= n;
             return iterator(&buf[idx]);
         }
 
@@ -253,6 +294,10 @@ namespace bse {
             return buf_pos;
         }
 
+        std::size_t capacity() const {
+            return buf_cap;
+        }
+
         void clear() {
             while (buf_pos > 0) {
                 --buf_pos;
@@ -268,8 +313,8 @@ namespace bse {
                 return;
             }
 
-            if (cap == buf_cap) {
-                // Would change nothing
+            if (cap <= buf_cap) {
+                // Never shrinks below the current capacity
                 return;
             }
 
@@ -287,7 +332,7 @@ namespace bse {
     template<typename T, typename arg>
     std::size_t erase_if(vector<T>& vec, arg (*pred)(const T&), arg result) {
         std::size_t erased_els = 0;
-        for (typename vector<T>::Iterator it = vec.begin(); it != vec.end(); /*Do nothing*/) {
+        for (typename vector<T>::iterator it = vec.begin(); it != vec.end(); /*Do nothing*/) {
             if (pred(*it) == result) {
                 it = vec.erase(it);  // erase returns the iterator to the next element
                 ++erased_els;
@@ -1,7 +1,104 @@
 #include "Memory.h"
 
-void bse::memset(char* destination, const char value, std::size_t bytes) {
-    for (std::size_t byte = 0; byte < bytes; ++byte) {
-        *(destination + byte) = value;
+namespace {
+
+    bool aligned(const void* ptr) {
+        return (reinterpret_cast<std::size_t>(ptr) & 3) == 0;
+    }
+
+    // Copies from low to high addresses, also correct for overlapping regions if destination < source
+    void copy_forward(char* dst, const char* src, std::size_t bytes) {
+        // Bytewise until the destination is aligned, the reads may stay unaligned
+        while (bytes > 0 && !aligned(dst)) {
+            *dst++ = *src++;
+            --bytes;
+        }
+
+        std::size_t words = bytes >> 2;
+        std::size_t rest = bytes & 3;
+        asm volatile("rep movsl"
+                     : "+D"(dst), "+S"(src), "+c"(words)
+                     :
+                     : "memory");
+        asm volatile("rep movsb"
+                     : "+D"(dst), "+S"(src), "+c"(rest)
+                     :
+                     : "memory");
+    }
+
+    // Copies from high to low addresses, used for overlapping regions with destination > source
+    void copy_backward(char* dst, const char* src, std::size_t bytes) {
+        char* dst_end = dst + bytes;
+        const char* src_end = src + bytes;
+
+        while (bytes > 0 && !aligned(dst_end)) {
+            *--dst_end = *--src_end;
+            --bytes;
+        }
+
+        std::size_t words = bytes >> 2;
+        std::size_t rest = bytes & 3;
+        if (words > 0) {
+            // movs decrements esi/edi with the direction flag set, they have to point to the last word.
+            // gcc expects the direction flag to be cleared again.
+            char* dst_word = dst_end - 4;
+            const char* src_word = src_end - 4;
+            asm volatile("std\n\t"
+                         "rep movsl\n\t"
+                         "cld"
+                         : "+D"(dst_word), "+S"(src_word), "+c"(words)
+                         :
+                         : "memory");
+        }
+
+        // The unaligned head
+        while (rest > 0) {
+            --rest;
+            dst[rest] = src[rest];
+        }
+    }
+
+}  // namespace
+
+void bse::memcpy_bytes(void* destination, const void* source, std::size_t bytes) {
+    copy_forward(static_cast<char*>(destination), static_cast<const char*>(source), bytes);
+}
+
+void bse::memmove(void* destination, const void* source, std::size_t bytes) {
+    char* dst = static_cast<char*>(destination);
+    const char* src = static_cast<const char*>(source);
+
+    if (dst < src || dst >= src + bytes) {
+        copy_forward(dst, src, bytes);
+    } else if (dst > src) {
+        copy_backward(dst, src, bytes);
     }
 }
+
+void bse::memset(void* destination, const char value, std::size_t bytes) {
+    char* dst = static_cast<char*>(destination);
+
+    while (bytes > 0 && !aligned(dst)) {
+        *dst++ = value;
+        --bytes;
+    }
+
+    unsigned int pattern = static_cast<unsigned char>(value) * 0x01010101U;
+    std::size_t words = bytes >> 2;
+    std::size_t rest = bytes & 3;
+    asm volatile("rep stosl"
+                 : "+D"(dst), "+c"(words)
+                 : "a"(pattern)
+                 : "memory");
+    asm volatile("rep stosb"
+                 : "+D"(dst), "+c"(rest)
+                 : "a"(pattern)
+                 : "memory");
+}
+
+void bse::memset32(unsigned int* destination, unsigned int value, std::size_t count) {
+    asm volatile("rep stosl"
+                 : "+D"(destination), "+c"(count)
+                 : "a"(value)
+                 : "memory");
+}
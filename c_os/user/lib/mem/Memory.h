@@ -1,24 +1,52 @@
 #ifndef MYSTDLIB_INCLUDE_H_
 #define MYSTDLIB_INCLUDE_H_
 
+#include <type_traits>
 #include <utility>
 
 namespace bse {
 
     // add using byte or sth to replace char
 
+    // NOTE: The kernel is compiled with -O0, so plain loops copy a single element per iteration with
+    //       multiple memory accesses for the loop variable. These copy/fill the aligned middle part
+    //       with rep movsd/rep stosd (available since the 386) and only handle the unaligned head
+    //       and tail bytewise.
+
+    // Regions must not overlap
+    void memcpy_bytes(void* destination, const void* source, std::size_t bytes);
+
+    // Regions may overlap
+    void memmove(void* destination, const void* source, std::size_t bytes);
+
+    void memset(void* destination, char value, std::size_t bytes);
+
+    // Fills count 32 bit words, e.g. pixels in a 32 bpp framebuffer
+    void memset32(unsigned int* destination, unsigned int value, std::size_t count);
+
     template<typename T>
     void memcpy(T* destination, const T* source, std::size_t count = 1) {
-        for (unsigned int i = 0; i < count; ++i) {
-            *(destination + i) = *(source + i);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            memcpy_bytes(destination, source, count * sizeof(T));
+        } else {
+            for (unsigned int i = 0; i < count; ++i) {
+                *(destination + i) = *(source + i);
+            }
         }
     }
 
-    void memset(char* destination, char value, std::size_t bytes);
+    // Types that can be moved to another address by copying their bytes, the old bytes are then
+    // treated as raw memory (no destructor call). Containers use this to shift elements in bulk.
+    // Specialize this for types that own resources through pointers but don't point into themselves.
+    template<typename T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    template<typename T>
+    constexpr const bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
 
     template<typename T>
     void zero(T* destination) {
-        memset(reinterpret_cast<char*>(destination), '\0', sizeof(T));
+        memset(destination, '\0', sizeof(T));
     }
 
 }  // namespace bse
@@ -1,6 +1,7 @@
 #ifndef UniquePointer_Include_H_
 #define UniquePointer_Include_H_
 
+#include "user/lib/mem/Memory.h"
 #include <utility>
 
 // https://en.cppreference.com/w/cpp/memory/unique_ptr
@@ -127,6 +128,10 @@ namespace bse {
         return unique_ptr<T>(new T_[size]);
     }
 
+    // The pointer doesn't depend on the address of the unique_ptr, so it can be moved around bytewise
+    template<typename T>
+    struct is_trivially_relocatable<unique_ptr<T>> : std::true_type {};
+
 }  // namespace bse
 
 #endif
@@ -0,0 +1,64 @@
+#include "user/lib/utility/LogRing.h"
+#include "kernel/CPU.h"
+
+bool LogRing::push(unsigned char level, bse::string_view message) {
+    unsigned int pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    record* slot;
+
+    while (true) {
+        slot = &slots[pos & (SIZE - 1)];
+        int diff = static_cast<int>(slot->seq - pos);
+
+        if (diff == 0) {
+            // The slot is free for this position, try to claim it (reloads pos on failure)
+            if (__atomic_compare_exchange_n(&head, &pos, pos + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The slot still holds a record from the last round, the consumer is behind
+            __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            // Another producer claimed this position
+            pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->tsc = CPU::rdtsc();
+    slot->level = level;
+
+    unsigned int len = 0;
+    for (char c : message) {
+        if (c == '\0' || len >= TEXT) {
+            break;
+        }
+        slot->text[len++] = c;
+    }
+    slot->len = len;
+
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool LogRing::pop(record& out) {
+    record& slot = slots[tail & (SIZE - 1)];
+    if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != tail + 1) {
+        return false;
+    }
+
+    out.tsc = slot.tsc;
+    out.level = slot.level;
+    out.len = slot.len;
+    for (unsigned int i = 0; i < slot.len; ++i) {
+        out.text[i] = slot.text[i];
+    }
+
+    // Free the slot for the next round
+    __atomic_store_n(&slot.seq, tail + SIZE, __ATOMIC_RELEASE);
+    ++tail;
+    return true;
+}
+
+unsigned int LogRing::take_dropped() {
+    return __atomic_exchange_n(&dropped, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,51 @@
+#ifndef LogRing_Include_H_
+#define LogRing_Include_H_
+
+#include "user/lib/StringView.h"
+
+// NOTE: Writing a log message to serial busy-waits for every single character, so the loggers only
+//       put their finished lines into this ring and a low priority thread writes them out later.
+//       Any number of producers (threads, interrupt handlers) can push without taking a lock:
+//       A producer claims a slot by incrementing head with cmpxchg, fills it and then publishes it
+//       by setting the slot's sequence number. The single consumer only reads slots that have been
+//       published. If the ring is full the message is dropped and counted instead of waiting.
+class LogRing {
+public:
+    static constexpr const unsigned int SIZE = 128;  // Power of 2
+    static constexpr const unsigned int TEXT = 80;   // Same as the StringBuffer of the Logger
+
+    struct record {
+        volatile unsigned int seq;  // == position + 1 if the record is ready to be read
+        unsigned long long tsc;
+        unsigned char level;
+        unsigned char len;
+        char text[TEXT];
+    };
+
+private:
+    record slots[SIZE];
+    unsigned int head = 0;  // Next position to claim (producers)
+    unsigned int tail = 0;  // Next position to read (consumer)
+    unsigned int dropped = 0;
+
+public:
+    LogRing(const LogRing& copy) = delete;
+
+    LogRing() {
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            slots[i].seq = i;
+        }
+    }
+
+    // Returns false if the message was dropped, longer messages are cut off
+    bool push(unsigned char level, bse::string_view message);
+
+    // Copies the oldest record to out, returns false if there is nothing to read
+    // Only a single thread may read at a time
+    bool pop(record& out);
+
+    // Number of dropped messages since the last call
+    unsigned int take_dropped();
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 bool Logger::kout_enabled = true;
 bool Logger::serial_enabled = true;
+bool Logger::deferred = false;
 
 Logger::LogLevel Logger::level = Logger::ERROR;
 
@@ -15,84 +16,173 @@ constexpr const char* ansi_cyan = "\033[1;36m";
 constexpr const char* ansi_white = "\033[1;37m";
 constexpr const char* ansi_default = "\033[0;39m ";
 
-void Logger::log(const bse::string_view message, CGA::color col) const {
+// Writes the timestamp as hex, 64 bit divisions aren't available
+void write_tsc(unsigned long long tsc) {
+    constexpr const char* digits = "0123456789abcdef";
+    char text[19];
+
+    text[0] = '[';
+    for (int i = 15; i >= 0; --i) {
+        text[16 - i] = digits[(tsc >> (4 * i)) & 0xF];
+    }
+    text[17] = ']';
+    text[18] = ' ';
+    SerialOut::write(bse::string_view(text, 19));
+}
+
+void Logger::log(const LogRing::record& record) const {
+    LogLevel lvl = static_cast<LogLevel>(record.level);
+    bse::string_view message(record.text, record.len);
+
+    CGA::color col;
+    switch (lvl) {
+    case Logger::TRACE:
+        col = CGA::WHITE;
+        break;
+    case Logger::DEBUG:
+        col = CGA::LIGHT_MAGENTA;
+        break;
+    case Logger::ERROR:
+        col = CGA::LIGHT_RED;
+        break;
+    default:
+        col = CGA::LIGHT_BLUE;
+    }
+
     if (Logger::kout_enabled) {
         CGA::color old_col = kout.color_fg;
         kout << fgc(col)
-             << Logger::level_to_string(current_message_level) << "::"
+             << Logger::level_to_string(lvl) << "::"
              << message << fgc(old_col);
         kout.flush();  // Don't add newline, Logger already does that
     }
     if (Logger::serial_enabled) {
-        switch (col) {
-        case CGA::WHITE:
-            SerialOut::write(ansi_white);
-            break;
-        case CGA::LIGHT_MAGENTA:
-            SerialOut::write(ansi_magenta);
-            break;
-        case CGA::LIGHT_RED:
-            SerialOut::write(ansi_red);
-            break;
-        case CGA::LIGHT_BLUE:
-            SerialOut::write(ansi_blue);
-            break;
-        default:
-            SerialOut::write(ansi_default);
-        }
-        SerialOut::write(Logger::level_to_string(current_message_level));
-        SerialOut::write(":: ");
-        SerialOut::write(message);
-        SerialOut::write('\r');
-        // serial.write("\r\n");
+        log_serial(record);
     }
 }
 
-void Logger::flush() {
-    buffer[pos] = '\0';
+void Logger::log_serial(const LogRing::record& record) const {
+    LogLevel lvl = static_cast<LogLevel>(record.level);
 
-    switch (current_message_level) {
+    switch (lvl) {
     case Logger::TRACE:
-        trace(buffer.data());
+        SerialOut::write(ansi_white);
         break;
     case Logger::DEBUG:
-        debug(buffer.data());
+        SerialOut::write(ansi_magenta);
         break;
     case Logger::ERROR:
-        error(buffer.data());
-        break;
-    case Logger::INFO:
-        info(buffer.data());
+        SerialOut::write(ansi_red);
         break;
+    default:
+        SerialOut::write(ansi_blue);
     }
+    write_tsc(record.tsc);
+    SerialOut::write(Logger::level_to_string(lvl));
+    SerialOut::write(":: ");
+    SerialOut::write(bse::string_view(record.text, record.len));
+    SerialOut::write('\r');
+    // serial.write("\r\n");
+}
 
-    current_message_level = Logger::INFO;
-    pos = 0;
-    Logger::unlock();
+void Logger::drain() {
+    Logger& logger = Logger::instance();
+    LogRing::record record;
+
+    while (logger.ring.pop(record)) {
+        logger.log(record);
+    }
+    logger.write_dropped();
 }
 
-void Logger::trace(const bse::string_view message) const {
-    if (Logger::level <= Logger::TRACE) {
-        log(message, CGA::WHITE);
+void Logger::drain_serial() {
+    Logger& logger = Logger::instance();
+    LogRing::record record;
+
+    // Neither the Logger lock nor kout is touched, the crashed thread might have held them
+    while (logger.ring.pop(record)) {
+        if (Logger::serial_enabled) {
+            logger.log_serial(record);
+        }
     }
+    logger.write_dropped();
 }
 
-void Logger::debug(const bse::string_view message) const {
-    if (Logger::level <= Logger::DEBUG) {
-        log(message, CGA::LIGHT_MAGENTA);
+void Logger::write_dropped() {
+    unsigned int dropped = ring.take_dropped();
+    if (dropped > 0 && Logger::serial_enabled) {
+        SerialOut::write(ansi_red);
+        SerialOut::write("LOG:: Ring full, dropped messages: ");
+        char text[10];
+        int len = 0;
+        do {
+            text[9 - len++] = '0' + dropped % 10;
+            dropped /= 10;
+        } while (dropped > 0);
+        SerialOut::write(bse::string_view(&text[10 - len], len));
+        SerialOut::write("\n\r");
     }
 }
 
-void Logger::error(const bse::string_view message) const {
-    if (Logger::level <= Logger::ERROR) {
-        log(message, CGA::LIGHT_RED);
+void Logger::submit(unsigned char lvl, const bse::string_view message) {
+    if (Logger::level > lvl) {
+        return;
     }
+
+    ring.push(lvl, message);
+    if (!Logger::deferred) {
+        // Nobody else would write it
+        drain();
+    }
+}
+
+void Logger::lock() {
+    Logger& logger = Logger::instance();
+    logger.sem.acquire();
+    logger.owner = scheduler.preemption_enabled() ? scheduler.get_active() : 0;
 }
 
-void Logger::info(const bse::string_view message) const {
-    if (Logger::level <= Logger::INFO) {
-        log(message, CGA::LIGHT_BLUE);
+void Logger::unlock() {
+    Logger& logger = Logger::instance();
+    logger.owner = 0;
+    logger.sem.release();
+}
+
+void Logger::abandon(unsigned int tid) {
+    Logger& logger = Logger::instance();
+    if (tid == 0 || logger.owner != tid) {
+        return;
     }
+
+    logger.current_message_level = Logger::INFO;
+    logger.pos = 0;
+    Logger::unlock();
+}
+
+void Logger::flush() {
+    buffer[pos] = '\0';
+
+    submit(current_message_level, bse::string_view(buffer.data(), pos));
+
+    current_message_level = Logger::INFO;
+    pos = 0;
+    Logger::unlock();
+}
+
+void Logger::trace(const bse::string_view message) {
+    submit(Logger::TRACE, message);
+}
+
+void Logger::debug(const bse::string_view message) {
+    submit(Logger::DEBUG, message);
+}
+
+void Logger::error(const bse::string_view message) {
+    submit(Logger::ERROR, message);
+}
+
+void Logger::info(const bse::string_view message) {
+    submit(Logger::INFO, message);
 }
 
 // Manipulatoren
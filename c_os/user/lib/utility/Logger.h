@@ -4,6 +4,7 @@
 #include "devices/CGA.h"
 #include "lib/OutStream.h"
 #include "lib/SpinLock.h"
+#include "user/lib/utility/LogRing.h"
 #include "user/lib/String.h"
 #include "user/lib/StringView.h"
 
@@ -19,38 +20,70 @@ private:
 
     static bool kout_enabled;
     static bool serial_enabled;
+    static bool deferred;  // Set when the LogDrainThread runs, before that every message is written immediately
 
-    void log(const bse::string_view message, CGA::color col) const;
+    // Finished lines waiting for the LogDrainThread
+    LogRing ring;
 
-    friend class NamedLogger;  // Allow NamedLogger to lock/unlock
+    void log(const LogRing::record& record) const;
+    void log_serial(const LogRing::record& record) const;
+    void write_dropped();
+    void submit(unsigned char lvl, const bse::string_view message);
+
+    // NOTE: The lock only protects the shared format buffer while a message is assembled,
+    //       writing the message out happens in the LogDrainThread without it
 
     SpinLock sem;              // Semaphore would be a cyclic include
-    static void lock() { Logger::instance().sem.acquire(); }
-    static void unlock() { Logger::instance().sem.release(); }
+    unsigned int owner = 0;    // Thread that assembles a message, 0 if none or unknown
+    static void lock();
+    static void unlock();
     // static void lock() {}
     // static void unlock() {}
 
 public:
-//    ~Logger() override = default;
-
-    Logger(const Logger& copy) = delete;
-    void operator=(const Logger& copy) = delete;
-
     enum LogLevel {
         TRACE,
         DEBUG,
         ERROR,
         INFO
     };
+
+private:
+    template<LogLevel min_level>
+    friend class BasicNamedLogger;  // Allow BasicNamedLogger to lock/unlock
+
+public:
+//    ~Logger() override = default;
+
+    Logger(const Logger& copy) = delete;
+    void operator=(const Logger& copy) = delete;
+
     static LogLevel level;
     LogLevel current_message_level = Logger::INFO;  // Use this to log with manipulators
 
     void flush() override;
 
-    void trace(const bse::string_view message) const;
-    void debug(const bse::string_view message) const;
-    void error(const bse::string_view message) const;
-    void info(const bse::string_view message) const;
+    void trace(const bse::string_view message);
+    void debug(const bse::string_view message);
+    void error(const bse::string_view message);
+    void info(const bse::string_view message);
+
+    // Writes all waiting messages to CGA/serial, only called by a single thread at a time
+    static void drain();
+
+    // Writes all waiting messages to serial only, without taking any lock, for the bluescreen
+    // NOTE: Only call this with interrupts disabled when the system halts, the LogDrainThread mustn't run again
+    static void drain_serial();
+
+    // Drops the message thread 'tid' is assembling and frees the lock, if the thread died while holding it
+    static void abandon(unsigned int tid);
+
+    // Called once by the LogDrainThread, afterwards logging doesn't wait for the output anymore
+    static void enable_deferred() {
+        Logger::lock();
+        Logger::deferred = true;
+        Logger::unlock();
+    }
 
     // TODO: Make lvl change accessible over menu
     static void set_level(LogLevel lvl) {
@@ -90,32 +123,84 @@ Logger& DEBUG(Logger& log);
 Logger& ERROR(Logger& log);
 Logger& INFO(Logger& log);
 
-class NamedLogger {
+// Returned by BasicNamedLogger, forwards everything to the Logger if the message passed the level check.
+// In that case the Logger is locked until the message is finished with endl.
+class LogStream {
 private:
-    const char* name;
+    Logger* log;  // nullptr if the message is discarded
 
 public:
-    explicit NamedLogger(const char* name) : name(name) {}
+    explicit LogStream(Logger* log) : log(log) {}
 
-    Logger& trace() {
-        Logger::lock();
-        return Logger::instance() << TRACE << name << "::";
+    template<typename T>
+    LogStream& operator<<(const T& value) {
+        if (log != nullptr) {
+            *log << value;
+        }
+        return *this;
     }
 
-    Logger& debug() {
-        Logger::lock();
-        return Logger::instance() << DEBUG << name << "::";
+    // Manipulators (endl, hex, ...)
+    LogStream& operator<<(Logger& (*f)(Logger&)) {
+        if (log != nullptr) {
+            f(*log);
+        }
+        return *this;
     }
+};
+
+// Returned for levels that are disabled at compile time, the whole statement is optimized away
+// (only the arguments are still evaluated)
+class NullLogStream {
+public:
+    template<typename T>
+    __attribute__((always_inline)) NullLogStream& operator<<(const T& value) { return *this; }
+
+    __attribute__((always_inline)) NullLogStream& operator<<(Logger& (*f)(Logger&)) { return *this; }
+};
+
+// NOTE: Messages below min_level don't generate any code, so hot paths (allocator, interrupt dispatching, ...)
+//       can keep their trace statements. Enabled levels are compared with Logger::level before the lock is taken
+//       and before anything is formatted, so filtered messages only cost a comparison.
+template<Logger::LogLevel min_level>
+class BasicNamedLogger {
+private:
+    const char* name;
+
+    LogStream begin(Logger::LogLevel lvl) const {
+        if (Logger::level > lvl) {
+            return LogStream(nullptr);
+        }
 
-    Logger& error() {
         Logger::lock();
-        return Logger::instance() << ERROR << name << "::";
+        Logger& log = Logger::instance();
+        log.current_message_level = lvl;
+        log << name << "::";
+        return LogStream(&log);
     }
 
-    Logger& info() {
-        Logger::lock();
-        return Logger::instance() << INFO << name << "::";
+    template<Logger::LogLevel lvl>
+    auto message() const {
+        if constexpr (lvl < min_level) {
+            return NullLogStream();
+        } else {
+            return begin(lvl);
+        }
     }
+
+public:
+    explicit BasicNamedLogger(const char* name) : name(name) {}
+
+    // Can be used to guard expensive arguments with if constexpr
+    static constexpr bool enabled(Logger::LogLevel lvl) { return lvl >= min_level; }
+
+    auto trace() const { return message<Logger::TRACE>(); }
+    auto debug() const { return message<Logger::DEBUG>(); }
+    auto error() const { return message<Logger::ERROR>(); }
+    auto info() const { return message<Logger::INFO>(); }
 };
 
+// Everything can be enabled at runtime
+using NamedLogger = BasicNamedLogger<Logger::TRACE>;
+
 #endif
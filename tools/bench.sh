@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# bench.sh: Builds the kernel with BENCH=1, runs the scheduler benchmarks
+#           headless in qemu and prints the results (one line per benchmark).
+#
+# Usage: bench.sh [baseline.txt]
+#
+# With a baseline (the saved output of an earlier run) every benchmark whose
+# median got more than THRESHOLD percent slower is reported and the script
+# exits with 1, so it can be used to catch regressions.
+
+THRESHOLD=${THRESHOLD:-10}
+TIMEOUT=${TIMEOUT:-300}
+BASELINE="$1"
+
+cd "$(dirname "$0")/../c_os" || exit 1
+
+make BENCH=1 build-bench/bootdisk.vmi > /dev/null || exit 1
+
+OUT=$(mktemp)
+trap 'rm -f "$OUT"' EXIT
+
+timeout "$TIMEOUT" make -s BENCH=1 qemu-bench > "$OUT" 2>&1
+if ! grep -q "BENCH-DONE" "$OUT"; then
+    echo "bench.sh: benchmark didn't finish" >&2
+    tail -n 20 "$OUT" >&2
+    exit 1
+fi
+
+RESULTS=$(tr -d '\r' < "$OUT" | grep -o 'BENCH name=.*max=[0-9]*')
+echo "$RESULTS"
+
+if [ -z "$BASELINE" ]; then
+    exit 0
+fi
+
+# Compare the medians by benchmark name
+echo "$RESULTS" | awk -v threshold="$THRESHOLD" '
+    function field(line, key,    i, n, parts) {
+        n = split(line, parts, " ")
+        for (i = 1; i <= n; i++) {
+            if (index(parts[i], key "=") == 1) return substr(parts[i], length(key) + 2)
+        }
+        return ""
+    }
+    FNR == NR { base[field($0, "name")] = field($0, "median"); next }
+    {
+        name = field($0, "name")
+        median = field($0, "median")
+        if (!(name in base) || base[name] == 0) next
+        change = 100.0 * (median - base[name]) / base[name]
+        printf "%-20s %10d -> %10d  %+6.1f%%\n", name, base[name], median, change
+        if (change > threshold) regressed = 1
+    }
+    END { exit regressed }' "$BASELINE" - || {
+    echo "bench.sh: regression of more than $THRESHOLD% found" >&2
+    exit 1
+}
@@ -0,0 +1,73 @@
+#!/bin/sh
+#
+# profile.sh: Maps a profile dumped by the kernel (menu keys p/P) to functions.
+#
+# Usage: profile.sh serial.log [system] [-t]
+#
+# serial.log is the COM1 output, e.g. from 'make qemu | tee build/serial.log'.
+# system is the linked kernel with symbols (default: build/system).
+# With -t the samples are additionally broken down by thread id.
+# Only the last PROFILE-BEGIN/PROFILE-END block of the log is used.
+
+LOG=""
+SYSTEM=build/system
+PER_THREAD=0
+
+for arg in "$@"; do
+    case "$arg" in
+    -t) PER_THREAD=1 ;;
+    *)
+        if [ -z "$LOG" ]; then
+            LOG="$arg"
+        else
+            SYSTEM="$arg"
+        fi
+        ;;
+    esac
+done
+
+if [ -z "$LOG" ] || [ ! -f "$LOG" ] || [ ! -f "$SYSTEM" ]; then
+    echo "usage: profile.sh serial.log [system] [-t]" >&2
+    exit 1
+fi
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# Last dump only, "<eip> <tid> <count>" in hex
+tr -d '\r' < "$LOG" | awk '
+    /^PROFILE-BEGIN/ { n = 0; header = $2 " " $3; inside = 1; next }
+    /^PROFILE-END/   { inside = 0; done = 1; next }
+    inside && NF == 3 { lines[n++] = $0 }
+    END {
+        if (!done) exit 1
+        print header > "/dev/stderr"
+        for (i = 0; i < n; i++) print lines[i]
+    }' > "$TMP/samples" 2> "$TMP/header" || {
+    echo "profile.sh: no complete profile found in $LOG" >&2
+    exit 1
+}
+
+read TOTAL LOST < "$TMP/header"
+echo "Samples: $((0x$TOTAL)), lost: $((0x$LOST))"
+
+# addr2line prints function and location for every address
+awk '{ print "0x" $1 }' "$TMP/samples" | addr2line -f -C -e "$SYSTEM" | awk 'NR % 2 == 1' > "$TMP/functions"
+
+paste -d '\t' "$TMP/functions" "$TMP/samples" | awk -F '\t' -v per_thread=$PER_THREAD '
+    function hex(s,    i, v) {
+        v = 0
+        s = tolower(s)
+        for (i = 1; i <= length(s); i++) v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+        return v
+    }
+    {
+        split($2, f, " ")
+        count = hex(f[3])
+        key = per_thread ? $1 "\t" hex(f[2]) : $1
+        sum[key] += count
+        total += count
+    }
+    END {
+        for (k in sum) printf "%8d %6.2f%%  %s\n", sum[k], 100.0 * sum[k] / total, k
+    }' | sort -rn
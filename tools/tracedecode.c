@@ -0,0 +1,241 @@
+/*
+ * tracedecode: Converts the binary event trace the kernel sends over COM2
+ *              (see c_os/kernel/Trace.h) into the Chrome trace event format,
+ *              which can be opened with chrome://tracing or ui.perfetto.dev.
+ *
+ * Usage: tracedecode [-m mhz] trace.bin > trace.json
+ *
+ * Timestamps are rdtsc values. The CPU frequency is taken from -m or, if not
+ * given, estimated from the CLOCK records (systime is incremented every 10ms).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC       0x5254
+#define RECORD_SIZE 24
+#define MS_PER_TICK 10.0
+
+#define IRQ_TRACK 0x7fffffff /* Chrome tid for the interrupt track */
+
+enum event {
+   CLOCK = 1,
+   SWITCH = 2,
+   IRQ_ENTER = 3,
+   IRQ_EXIT = 4,
+   ALLOC = 5,
+   FREE = 6,
+   SEM_P = 7,
+   SEM_V = 8,
+   DROPPED = 9
+};
+
+struct record {
+   unsigned int event;
+   unsigned int tid;
+   unsigned long long tsc;
+   unsigned int arg0;
+   unsigned int arg1;
+};
+
+static unsigned int get16 (const unsigned char* p)
+ {
+   return p[0] | (p[1] << 8);
+ }
+
+static unsigned int get32 (const unsigned char* p)
+ {
+   return get16(p) | ((unsigned int)get16(p + 2) << 16);
+ }
+
+static void die (const char* str)
+ {
+   fprintf(stderr, "%s\n", str);
+   exit(1);
+ }
+
+/* Reads the whole capture, records are found by their magic so garbage
+ * (e.g. from a previous run or lost bytes) is skipped */
+static struct record* parse (const unsigned char* data, size_t size, size_t* count)
+ {
+   struct record* records = malloc((size / RECORD_SIZE + 1) * sizeof(struct record));
+   size_t pos = 0, skipped = 0;
+
+   if (records == NULL)
+      die("out of memory");
+
+   *count = 0;
+   while (pos + RECORD_SIZE <= size) {
+      const unsigned char* p = data + pos;
+      unsigned int event = get16(p + 2);
+
+      if (get16(p) != MAGIC || event < CLOCK || event > DROPPED) {
+         pos++;
+         skipped++;
+         continue;
+      }
+
+      records[*count].event = event;
+      records[*count].tid = get32(p + 4);
+      records[*count].tsc = get32(p + 8) | ((unsigned long long)get32(p + 12) << 32);
+      records[*count].arg0 = get32(p + 16);
+      records[*count].arg1 = get32(p + 20);
+      (*count)++;
+      pos += RECORD_SIZE;
+   }
+
+   if (skipped > 0)
+      fprintf(stderr, "tracedecode: skipped %zu bytes without valid record\n", skipped);
+   return records;
+ }
+
+/* TSC ticks per microsecond from the first and last CLOCK record */
+static double estimate_mhz (const struct record* records, size_t count)
+ {
+   const struct record* first = NULL;
+   const struct record* last = NULL;
+   size_t i;
+
+   for (i = 0; i < count; i++) {
+      if (records[i].event != CLOCK)
+         continue;
+      if (first == NULL)
+         first = &records[i];
+      last = &records[i];
+   }
+
+   if (first == NULL || last->arg0 <= first->arg0)
+      return 0.0;
+   return (double)(last->tsc - first->tsc) / ((last->arg0 - first->arg0) * MS_PER_TICK * 1000.0);
+ }
+
+static int first_event = 1;
+
+static void begin_event (const char* ph, const char* name, double ts, unsigned int tid)
+ {
+   printf("%s\n  {\"ph\": \"%s\", \"name\": \"%s\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f",
+          first_event ? "" : ",", ph, name, tid, ts);
+   first_event = 0;
+ }
+
+int main (int argc, char** argv)
+ {
+   double mhz = 0.0;
+   const char* file = NULL;
+   FILE* in;
+   unsigned char* data;
+   long size;
+   struct record* records;
+   size_t count, i;
+   unsigned long long start = 0;
+   unsigned int running = 0;    /* Thread that is currently on the CPU, 0 if unknown */
+   unsigned int irq_depth = 0;  /* Open interrupt slices */
+   unsigned int irq_orphans = 0; /* Exits of interrupts that were closed at a switch */
+   char name[32];
+
+   for (i = 1; i < (size_t)argc; i++) {
+      if (strcmp(argv[i], "-m") == 0 && i + 1 < (size_t)argc)
+         mhz = atof(argv[++i]);
+      else
+         file = argv[i];
+   }
+   if (file == NULL)
+      die("usage: tracedecode [-m mhz] trace.bin > trace.json");
+
+   in = fopen(file, "rb");
+   if (in == NULL)
+      die("can't open trace file");
+   fseek(in, 0, SEEK_END);
+   size = ftell(in);
+   fseek(in, 0, SEEK_SET);
+   data = malloc(size > 0 ? size : 1);
+   if (data == NULL || fread(data, 1, size, in) != (size_t)size)
+      die("can't read trace file");
+   fclose(in);
+
+   records = parse(data, size, &count);
+   if (count == 0)
+      die("no records found");
+
+   if (mhz <= 0.0)
+      mhz = estimate_mhz(records, count);
+   if (mhz <= 0.0) {
+      fprintf(stderr, "tracedecode: can't estimate the clock, assuming 1000 MHz (use -m)\n");
+      mhz = 1000.0;
+   }
+   start = records[0].tsc;
+
+   printf("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+   begin_event("M", "thread_name", 0.0, IRQ_TRACK);
+   printf(", \"args\": {\"name\": \"interrupts\"}}");
+
+   for (i = 0; i < count; i++) {
+      const struct record* r = &records[i];
+      double ts = (double)(r->tsc - start) / mhz;
+
+      switch (r->event) {
+      case SWITCH:
+         /* An interrupt that switches threads returns only when the
+          * thread runs again, close it here to keep the slices nested */
+         for (; irq_depth > 0; irq_depth--, irq_orphans++) {
+            begin_event("E", "irq", ts, IRQ_TRACK);
+            printf("}");
+         }
+         if (running != 0) {
+            begin_event("E", "running", ts, running);
+            printf("}");
+         }
+         running = r->arg1;
+         begin_event("B", "running", ts, running);
+         printf("}");
+         break;
+      case IRQ_ENTER:
+         snprintf(name, sizeof(name), "irq %u", r->arg0);
+         begin_event("B", name, ts, IRQ_TRACK);
+         printf(", \"args\": {\"tid\": %u}}", r->tid);
+         irq_depth++;
+         break;
+      case IRQ_EXIT:
+         if (irq_depth > 0) {
+            begin_event("E", "irq", ts, IRQ_TRACK);
+            printf("}");
+            irq_depth--;
+         } else if (irq_orphans > 0) {
+            irq_orphans--;
+         }
+         break;
+      case ALLOC:
+         begin_event("i", "alloc", ts, r->tid);
+         printf(", \"s\": \"t\", \"args\": {\"ptr\": \"0x%x\", \"size\": %u}}", r->arg0, r->arg1);
+         break;
+      case FREE:
+         begin_event("i", "free", ts, r->tid);
+         printf(", \"s\": \"t\", \"args\": {\"ptr\": \"0x%x\"}}", r->arg0);
+         break;
+      case SEM_P:
+         begin_event("i", r->arg1 ? "sem p (blocked)" : "sem p", ts, r->tid);
+         printf(", \"s\": \"t\", \"args\": {\"sem\": \"0x%x\"}}", r->arg0);
+         break;
+      case SEM_V:
+         begin_event("i", "sem v", ts, r->tid);
+         printf(", \"s\": \"t\", \"args\": {\"sem\": \"0x%x\", \"woken\": %u}}", r->arg0, r->arg1);
+         break;
+      case CLOCK:
+         begin_event("C", "systime", ts, 0);
+         printf(", \"args\": {\"ticks\": %u}}", r->arg0);
+         break;
+      case DROPPED:
+         begin_event("i", "records dropped", ts, r->tid);
+         printf(", \"s\": \"g\", \"args\": {\"count\": %u}}", r->arg0);
+         break;
+      }
+   }
+
+   printf("\n]}\n");
+   fprintf(stderr, "tracedecode: %zu records, %.1f MHz\n", count, mhz);
+
+   free(records);
+   free(data);
+   return 0;
+ }